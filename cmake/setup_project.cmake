@@ -15,6 +15,14 @@ set(SHARED_SOURCE
         "${PROJECT_SOURCE_DIR}/src/common/src/shader.cpp"
         "${PROJECT_SOURCE_DIR}/src/common/src/pch.cpp"
         "${PROJECT_SOURCE_DIR}/src/common/src/utility.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/thread_pool.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/readback.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/image_capture.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/hdr_image.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/frame_recorder.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/gpu_timer.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/cubemap.cpp"
+        "${PROJECT_SOURCE_DIR}/src/common/src/socket.cpp"
         )
 set(SHARED_INCLUDE "${PROJECT_SOURCE_DIR}/src/common/include")
 
@@ -50,4 +58,10 @@ message(STATUS "Linking tinyobjloader to project.")
 target_link_libraries(${SAMPLE_NAME} tinyobjloader)
 
 message(STATUS "Linking ImGui to project.")
-target_link_libraries(${SAMPLE_NAME} imgui)
\ No newline at end of file
+target_link_libraries(${SAMPLE_NAME} imgui)
+
+# Winsock (socket.cpp).
+if (WIN32)
+    message(STATUS "Linking Winsock to project.")
+    target_link_libraries(${SAMPLE_NAME} ws2_32)
+endif()
\ No newline at end of file
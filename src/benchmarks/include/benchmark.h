@@ -0,0 +1,73 @@
+#pragma once
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Keeps the compiler from discarding the computation of a value whose result is otherwise unused.
+    template <typename DataType>
+    inline void DoNotOptimize(const DataType& value) {
+    #if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+    #else
+        static volatile const void* sink;
+        sink = &value;
+    #endif
+    }
+
+    struct BenchmarkResult {
+        std::string name;
+
+        // Set for benchmarks that could not run (for example, without an OpenGL context).
+        bool skipped;
+        std::string reason;
+
+        std::size_t iterations; // Per repetition.
+        int repetitions;
+
+        // Time per iteration, in nanoseconds, over all repetitions.
+        double minimum;
+        double median;
+        double mean;
+        double maximum;
+
+        // Additional per-benchmark values (problem sizes, hit rates, ...).
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    // Times small, repeatable operations.
+    // The iteration count of a benchmark is doubled until a single repetition runs for at least the minimum time, then
+    // the benchmark is repeated with that count. Reported times are per iteration.
+    class BenchmarkRunner {
+        public:
+            // Benchmarks whose name does not contain 'filter' are not run (an empty filter runs all benchmarks).
+            BenchmarkRunner(double minimumTime, int repetitions, std::string filter);
+            ~BenchmarkRunner();
+
+            // The benchmark executes the given number of iterations of the timed operation.
+            void Run(const std::string& name, const std::function<void(std::size_t)>& benchmark, std::vector<std::pair<std::string, double>> counters = { });
+            void Skip(const std::string& name, const std::string& reason);
+
+            [[nodiscard]] bool IsEnabled(const std::string& name) const;
+
+            // Describes the machine and build the results were measured on (compiler, renderer, ...).
+            void SetContext(const std::string& key, const std::string& value);
+
+            // Writes all results as a JSON object:
+            // { "context": { <key>: <value>, ... }, "benchmarks": [ { "name": ..., "iterations": ..., ... }, ... ] }
+            void WriteJSON(std::ostream& stream) const;
+
+            [[nodiscard]] const std::vector<BenchmarkResult>& GetResults() const;
+
+        private:
+            [[nodiscard]] double Time(const std::function<void(std::size_t)>& benchmark, std::size_t iterations) const;
+
+            double minimumTime_; // Seconds.
+            int repetitions_;
+            std::string filter_;
+
+            std::vector<std::pair<std::string, std::string>> context_;
+            std::vector<BenchmarkResult> results_;
+    };
+
+}
@@ -0,0 +1,187 @@
+
+#include "pch.h"
+#include "benchmark.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        std::string EscapeJSON(const std::string& string) {
+            std::string escaped;
+            escaped.reserve(string.size());
+
+            for (char character : string) {
+                switch (character) {
+                    case '"':
+                        escaped += "\\\"";
+                        break;
+                    case '\\':
+                        escaped += "\\\\";
+                        break;
+                    case '\n':
+                        escaped += "\\n";
+                        break;
+                    case '\t':
+                        escaped += "\\t";
+                        break;
+                    default:
+                        // Remaining control characters have no short escape sequence.
+                        if (static_cast<unsigned char>(character) < 0x20) {
+                            char code[7];
+                            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(character));
+                            escaped += code;
+                        }
+                        else {
+                            escaped += character;
+                        }
+                        break;
+                }
+            }
+
+            return escaped;
+        }
+
+        // JSON has no representation for infinity or NaN.
+        std::string FormatNumber(double value) {
+            if (!std::isfinite(value)) {
+                return "null";
+            }
+
+            std::ostringstream stream;
+            stream.precision(9);
+            stream << value;
+            return stream.str();
+        }
+
+    }
+
+    BenchmarkRunner::BenchmarkRunner(double minimumTime, int repetitions, std::string filter) : minimumTime_(minimumTime),
+                                                                                                 repetitions_(std::max(repetitions, 1)),
+                                                                                                 filter_(std::move(filter)) {
+    }
+
+    BenchmarkRunner::~BenchmarkRunner() {
+    }
+
+    void BenchmarkRunner::Run(const std::string& name, const std::function<void(std::size_t)>& benchmark, std::vector<std::pair<std::string, double>> counters) {
+        if (!IsEnabled(name)) {
+            return;
+        }
+
+        // Warm up caches (and lazily initialized state), and find an iteration count long enough to time reliably.
+        std::size_t iterations = 1;
+        while (Time(benchmark, iterations) < minimumTime_ && iterations < (std::size_t(1) << 40)) {
+            iterations *= 2;
+        }
+
+        std::vector<double> times(repetitions_);
+        for (double& time : times) {
+            time = Time(benchmark, iterations) * 1e9 / static_cast<double>(iterations);
+        }
+
+        std::sort(times.begin(), times.end());
+
+        BenchmarkResult result { };
+        result.name = name;
+        result.skipped = false;
+        result.iterations = iterations;
+        result.repetitions = repetitions_;
+        result.minimum = times.front();
+        result.maximum = times.back();
+        result.median = times.size() % 2 ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2.0;
+
+        double sum = 0.0;
+        for (double time : times) {
+            sum += time;
+        }
+        result.mean = sum / static_cast<double>(times.size());
+
+        result.counters = std::move(counters);
+
+        std::cerr << name << ": " << result.median << " ns (" << iterations << " iterations, " << repetitions_ << " repetitions)" << std::endl;
+
+        results_.emplace_back(std::move(result));
+    }
+
+    void BenchmarkRunner::Skip(const std::string& name, const std::string& reason) {
+        if (!IsEnabled(name)) {
+            return;
+        }
+
+        BenchmarkResult result { };
+        result.name = name;
+        result.skipped = true;
+        result.reason = reason;
+
+        std::cerr << name << ": skipped (" << reason << ")" << std::endl;
+
+        results_.emplace_back(std::move(result));
+    }
+
+    bool BenchmarkRunner::IsEnabled(const std::string& name) const {
+        return filter_.empty() || name.find(filter_) != std::string::npos;
+    }
+
+    void BenchmarkRunner::SetContext(const std::string& key, const std::string& value) {
+        context_.emplace_back(key, value);
+    }
+
+    void BenchmarkRunner::WriteJSON(std::ostream& stream) const {
+        stream << "{" << std::endl;
+        stream << "    \"context\": {";
+
+        for (std::size_t i = 0; i < context_.size(); ++i) {
+            stream << (i ? "," : "") << std::endl;
+            stream << "        \"" << EscapeJSON(context_[i].first) << "\": \"" << EscapeJSON(context_[i].second) << "\"";
+        }
+
+        stream << std::endl << "    }," << std::endl;
+        stream << "    \"benchmarks\": [";
+
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const BenchmarkResult& result = results_[i];
+
+            stream << (i ? "," : "") << std::endl;
+            stream << "        {" << std::endl;
+            stream << "            \"name\": \"" << EscapeJSON(result.name) << "\"," << std::endl;
+
+            if (result.skipped) {
+                stream << "            \"skipped\": true," << std::endl;
+                stream << "            \"reason\": \"" << EscapeJSON(result.reason) << "\"" << std::endl;
+                stream << "        }";
+                continue;
+            }
+
+            stream << "            \"skipped\": false," << std::endl;
+            stream << "            \"iterations\": " << result.iterations << "," << std::endl;
+            stream << "            \"repetitions\": " << result.repetitions << "," << std::endl;
+            stream << "            \"time_unit\": \"ns\"," << std::endl;
+            stream << "            \"minimum\": " << FormatNumber(result.minimum) << "," << std::endl;
+            stream << "            \"median\": " << FormatNumber(result.median) << "," << std::endl;
+            stream << "            \"mean\": " << FormatNumber(result.mean) << "," << std::endl;
+            stream << "            \"maximum\": " << FormatNumber(result.maximum) << "," << std::endl;
+            stream << "            \"counters\": {";
+
+            for (std::size_t j = 0; j < result.counters.size(); ++j) {
+                stream << (j ? ", " : " ") << "\"" << EscapeJSON(result.counters[j].first) << "\": " << FormatNumber(result.counters[j].second);
+            }
+
+            stream << (result.counters.empty() ? "}" : " }") << std::endl;
+            stream << "        }";
+        }
+
+        stream << std::endl << "    ]" << std::endl;
+        stream << "}" << std::endl;
+    }
+
+    const std::vector<BenchmarkResult>& BenchmarkRunner::GetResults() const {
+        return results_;
+    }
+
+    double BenchmarkRunner::Time(const std::function<void(std::size_t)>& benchmark, std::size_t iterations) const {
+        auto start = std::chrono::steady_clock::now();
+        benchmark(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
@@ -0,0 +1,423 @@
+
+#include "pch.h"
+#include "benchmark.h"
+#include "shader.h"
+#include "transform.h"
+#include "camera.h"
+#include "object_loader.h"
+#include "primitives.h"
+
+#include <random>
+#include <ctime>
+
+namespace {
+
+    // Returns the value following the given option on the command line, or 'fallback' if the option is not present.
+    std::string GetOption(const std::vector<std::string>& arguments, const std::string& option, const std::string& fallback) {
+        auto iterator = std::find(arguments.begin(), arguments.end(), option);
+        if (iterator == arguments.end() || iterator + 1 == arguments.end()) {
+            return fallback;
+        }
+
+        return *(iterator + 1);
+    }
+
+    int GetOption(const std::vector<std::string>& arguments, const std::string& option, int fallback) {
+        std::string value = GetOption(arguments, option, std::to_string(fallback));
+
+        try {
+            return std::stoi(value);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value '" << value << "' for option " << option << ", using " << fallback << "." << std::endl;
+            return fallback;
+        }
+    }
+
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 direction;
+    };
+
+    // Rays start on a sphere of radius 10 around the origin and point towards random positions within [-extent, extent]
+    // on every axis. Primitives of size 1 at the origin are therefore hit by some, but not all, rays.
+    std::vector<Ray> GenerateRays(std::size_t count, float extent) {
+        std::mt19937 generator(1337); // Fixed seed, every run traces the same rays.
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+        std::vector<Ray> rays(count);
+        for (Ray& ray : rays) {
+            glm::vec3 origin;
+            do {
+                origin = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+            } while (glm::dot(origin, origin) < 0.01f);
+
+            ray.origin = glm::normalize(origin) * 10.0f;
+
+            glm::vec3 target = glm::vec3(distribution(generator), distribution(generator), distribution(generator)) * extent;
+            ray.direction = glm::normalize(target - ray.origin);
+        }
+
+        return rays;
+    }
+
+    // Writes a (width x width quad) height field, which makes for meshes of any size with shared vertices.
+    // Returns the path to the written file.
+    std::string WriteGridOBJ(const std::string& directory, int width) {
+        std::string filepath = directory + "grid_" + std::to_string(width) + ".obj";
+
+        std::ofstream stream(filepath);
+        if (!stream.is_open()) {
+            throw std::runtime_error("Failed to write generated OBJ file: " + filepath);
+        }
+
+        for (int y = 0; y <= width; ++y) {
+            for (int x = 0; x <= width; ++x) {
+                float u = static_cast<float>(x) / static_cast<float>(width);
+                float v = static_cast<float>(y) / static_cast<float>(width);
+                stream << "v " << u << " " << 0.1f * glm::sin(u * 20.0f) * glm::cos(v * 20.0f) << " " << v << "\n";
+            }
+        }
+
+        // OBJ indices start at 1, quads are triangulated by the loader.
+        for (int y = 0; y < width; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int index = y * (width + 1) + x + 1;
+                stream << "f " << index << " " << index + width + 1 << " " << index + width + 2 << " " << index + 1 << "\n";
+            }
+        }
+
+        return filepath;
+    }
+
+    void BenchmarkIntersections(OpenGL::BenchmarkRunner& runner) {
+        std::vector<Ray> rays = GenerateRays(4096, 1.5f);
+        std::size_t mask = rays.size() - 1;
+
+        OpenGL::Sphere sphere;
+        sphere.position = glm::vec3(0.0f);
+        sphere.radius = 1.0f;
+
+        OpenGL::AABB aabb;
+        aabb.position = glm::vec4(0.0f);
+        aabb.dimensions = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+
+        std::vector<OpenGL::Sphere> spheres { sphere };
+        std::vector<OpenGL::AABB> aabbs { aabb };
+
+        OpenGL::Instance instance;
+        instance.SetTransform(glm::rotate(glm::radians(30.0f), glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f))) * glm::scale(glm::vec3(1.5f, 1.0f, 0.75f)));
+        instance.primitiveType = OpenGL::PrimitiveType::AABB;
+
+        // Fraction of rays that hit, to tell apart changes in the kernel from changes in the test data.
+        std::size_t numSphereHits = 0;
+        std::size_t numAABBHits = 0;
+        std::size_t numInstanceHits = 0;
+
+        for (const Ray& ray : rays) {
+            float tMax = std::numeric_limits<float>::max();
+            numSphereHits += sphere.Intersects(ray.origin, ray.direction, 0.001f, tMax) ? 1 : 0;
+
+            tMax = std::numeric_limits<float>::max();
+            numAABBHits += aabb.Intersects(ray.origin, ray.direction, 0.001f, tMax) ? 1 : 0;
+
+            tMax = std::numeric_limits<float>::max();
+            numInstanceHits += instance.Intersects(spheres, aabbs, ray.origin, ray.direction, 0.001f, tMax) ? 1 : 0;
+        }
+
+        double numRays = static_cast<double>(rays.size());
+
+        runner.Run("intersection/ray_sphere", [&](std::size_t iterations) {
+            int numHits = 0;
+            for (std::size_t i = 0; i < iterations; ++i) {
+                const Ray& ray = rays[i & mask];
+                float tMax = std::numeric_limits<float>::max();
+                numHits += sphere.Intersects(ray.origin, ray.direction, 0.001f, tMax) ? 1 : 0;
+            }
+            OpenGL::DoNotOptimize(numHits);
+        }, { { "rays", numRays }, { "hit_rate", static_cast<double>(numSphereHits) / numRays } });
+
+        runner.Run("intersection/ray_aabb", [&](std::size_t iterations) {
+            int numHits = 0;
+            for (std::size_t i = 0; i < iterations; ++i) {
+                const Ray& ray = rays[i & mask];
+                float tMax = std::numeric_limits<float>::max();
+                numHits += aabb.Intersects(ray.origin, ray.direction, 0.001f, tMax) ? 1 : 0;
+            }
+            OpenGL::DoNotOptimize(numHits);
+        }, { { "rays", numRays }, { "hit_rate", static_cast<double>(numAABBHits) / numRays } });
+
+        runner.Run("intersection/ray_instance", [&](std::size_t iterations) {
+            int numHits = 0;
+            for (std::size_t i = 0; i < iterations; ++i) {
+                const Ray& ray = rays[i & mask];
+                float tMax = std::numeric_limits<float>::max();
+                numHits += instance.Intersects(spheres, aabbs, ray.origin, ray.direction, 0.001f, tMax) ? 1 : 0;
+            }
+            OpenGL::DoNotOptimize(numHits);
+        }, { { "rays", numRays }, { "hit_rate", static_cast<double>(numInstanceHits) / numRays } });
+    }
+
+    // Loading from disk (parsing, vertex deduplication, normalization and normals), loading a cached mesh (a copy),
+    // and recalculating the normals of the loaded mesh.
+    void BenchmarkMesh(OpenGL::BenchmarkRunner& runner, const std::string& name, const std::string& filepath) {
+        std::string loadName = "object_loader/load/" + name;
+        std::string cachedName = "object_loader/load_cached/" + name;
+        std::string normalsName = "mesh/recalculate_normals/" + name;
+
+        if (!runner.IsEnabled(loadName) && !runner.IsEnabled(cachedName) && !runner.IsEnabled(normalsName)) {
+            return;
+        }
+
+        OpenGL::ObjectLoader& loader = OpenGL::ObjectLoader::Instance();
+        OpenGL::Mesh mesh;
+
+        try {
+            mesh = loader.LoadFromFile(filepath);
+        }
+        catch (const std::runtime_error& error) {
+            runner.Skip(loadName, error.what());
+            runner.Skip(cachedName, error.what());
+            runner.Skip(normalsName, error.what());
+            return;
+        }
+
+        std::vector<std::pair<std::string, double>> counters { { "vertices", static_cast<double>(mesh.vertices.size()) },
+                                                               { "triangles", static_cast<double>(mesh.indices.size() / 3) } };
+
+        runner.Run(loadName, [&](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                loader.ClearCache();
+                OpenGL::Mesh loaded = loader.LoadFromFile(filepath);
+                OpenGL::DoNotOptimize(loaded.vertices.data());
+            }
+        }, counters);
+
+        runner.Run(cachedName, [&](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                OpenGL::Mesh loaded = loader.LoadFromFile(filepath);
+                OpenGL::DoNotOptimize(loaded.vertices.data());
+            }
+        }, counters);
+
+        runner.Run(normalsName, [&](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                // Normals are accumulated into the existing buffer.
+                mesh.normals.clear();
+                mesh.RecalculateNormals();
+                OpenGL::DoNotOptimize(mesh.normals.data());
+            }
+        }, counters);
+
+        loader.ClearCache();
+    }
+
+    void BenchmarkTransforms(OpenGL::BenchmarkRunner& runner) {
+        OpenGL::Camera camera(1280, 720);
+        camera.SetPosition(glm::vec3(0.0f, 0.0f, 25.0f));
+
+        // Moving the camera invalidates its matrices, which are recalculated on the next query.
+        runner.Run("camera/recalculate_matrices", [&](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                camera.SetPosition(glm::vec3(static_cast<float>(i & 1023) * 0.01f, 0.0f, 25.0f));
+                OpenGL::DoNotOptimize(camera.GetCameraTransform());
+            }
+        });
+
+        OpenGL::Transform transform;
+        transform.SetPosition(1.0f, 2.0f, 3.0f);
+        transform.SetScale(2.0f, 2.0f, 2.0f);
+
+        runner.Run("transform/get_transform", [&](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                transform.SetRotation(static_cast<float>(i & 1023) * 0.1f, 45.0f, 0.0f);
+                OpenGL::DoNotOptimize(transform.GetTransform());
+            }
+        });
+
+        // Unchanged transforms return the stored matrix.
+        runner.Run("transform/get_transform_unchanged", [&](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i) {
+                OpenGL::DoNotOptimize(transform.GetTransform());
+            }
+        });
+    }
+
+    // OpenGL benchmarks run in a hidden window.
+    // Returns nullptr on failure, GLFW is terminated in that case.
+    GLFWwindow* CreateHiddenWindow() {
+        if (!glfwInit()) {
+            return nullptr;
+        }
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        GLFWwindow* window = glfwCreateWindow(64, 64, "Benchmarks", nullptr, nullptr);
+        if (!window) {
+            glfwTerminate();
+            return nullptr;
+        }
+
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return nullptr;
+        }
+
+        return window;
+    }
+
+    // Overhead of Shader::SetUniform (name lookup in the uniform location cache) over setting the uniform directly.
+    void BenchmarkShaderUniforms(OpenGL::BenchmarkRunner& runner) {
+        std::vector<std::string> names = { "shader/set_uniform/float", "shader/set_uniform/int", "shader/set_uniform/inactive", "shader/gl_uniform/float" };
+
+        if (std::none_of(names.begin(), names.end(), [&runner](const std::string& name) { return runner.IsEnabled(name); })) {
+            return;
+        }
+
+        GLFWwindow* window = CreateHiddenWindow();
+        if (!window) {
+            for (const std::string& name : names) {
+                runner.Skip(name, "no OpenGL 4.6 context");
+            }
+            return;
+        }
+
+        runner.SetContext("renderer", (const char*)(glGetString(GL_RENDERER)));
+
+        {
+            std::unique_ptr<OpenGL::Shader> shader;
+            try {
+                shader = std::make_unique<OpenGL::Shader>("Post Processing", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/post_processing.comp" });
+            }
+            catch (const std::runtime_error& error) {
+                for (const std::string& name : names) {
+                    runner.Skip(name, error.what());
+                }
+            }
+
+            if (shader) {
+                shader->Bind();
+
+                GLint program;
+                glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+                GLint exposureLocation = glGetUniformLocation(program, "exposure");
+
+                runner.Run("shader/set_uniform/float", [&](std::size_t iterations) {
+                    for (std::size_t i = 0; i < iterations; ++i) {
+                        shader->SetUniform("exposure", static_cast<float>(i & 1));
+                    }
+                });
+
+                runner.Run("shader/set_uniform/int", [&](std::size_t iterations) {
+                    for (std::size_t i = 0; i < iterations; ++i) {
+                        shader->SetUniform("outputImage", static_cast<int>(i & 1));
+                    }
+                });
+
+                // Uniforms that are not part of the program (location -1) are cached, and ignored by OpenGL.
+                runner.Run("shader/set_uniform/inactive", [&](std::size_t iterations) {
+                    for (std::size_t i = 0; i < iterations; ++i) {
+                        shader->SetUniform("inactiveUniform", static_cast<float>(i & 1));
+                    }
+                });
+
+                runner.Run("shader/gl_uniform/float", [&](std::size_t iterations) {
+                    for (std::size_t i = 0; i < iterations; ++i) {
+                        glUniform1f(exposureLocation, static_cast<float>(i & 1));
+                    }
+                });
+
+                shader->Unbind();
+            }
+        }
+
+        glFinish();
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    std::string GetCompiler() {
+    #if defined(__clang__)
+        return "clang " __clang_version__;
+    #elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+    #elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+    #else
+        return "unknown";
+    #endif
+    }
+
+}
+
+// Times the CPU-side hot paths of the common code and the path tracing sample, and writes the results as JSON.
+// Run from the repository root (assets are loaded relative to it).
+//     [--filter <substring of benchmark names>] [--min-time 100 (ms per repetition)] [--repetitions 5] [--output <file>]
+int main(int argc, char* argv[]) {
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    OpenGL::BenchmarkRunner runner(static_cast<double>(glm::max(GetOption(arguments, "--min-time", 100), 1)) / 1000.0,
+                                   GetOption(arguments, "--repetitions", 5),
+                                   GetOption(arguments, "--filter", std::string()));
+
+    char date[32];
+    std::time_t time = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&time));
+
+    runner.SetContext("date", date);
+    runner.SetContext("compiler", GetCompiler());
+    #ifdef NDEBUG
+    runner.SetContext("build", "release");
+    #else
+    runner.SetContext("build", "debug");
+    #endif
+    runner.SetContext("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+    BenchmarkIntersections(runner);
+    BenchmarkTransforms(runner);
+
+    BenchmarkMesh(runner, "bunny", "src/common/assets/models/bunny.obj");
+
+    // Larger meshes are generated, and removed once measured.
+    std::string directory = (std::filesystem::temp_directory_path() / "opengl-samples-benchmarks").string() + "/";
+    std::filesystem::create_directories(directory);
+
+    for (int width : { 64, 256, 512 }) {
+        std::string name = "grid_" + std::to_string(width);
+        if (!runner.IsEnabled("object_loader/load/" + name) && !runner.IsEnabled("object_loader/load_cached/" + name) && !runner.IsEnabled("mesh/recalculate_normals/" + name)) {
+            continue;
+        }
+
+        try {
+            BenchmarkMesh(runner, name, WriteGridOBJ(directory, width));
+        }
+        catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+
+    BenchmarkShaderUniforms(runner);
+
+    std::string output = GetOption(arguments, "--output", std::string());
+    if (output.empty()) {
+        runner.WriteJSON(std::cout);
+        return 0;
+    }
+
+    std::ofstream stream(output);
+    if (!stream.is_open()) {
+        std::cerr << "Failed to write '" << output << "'." << std::endl;
+        return 1;
+    }
+
+    runner.WriteJSON(stream);
+    return 0;
+}
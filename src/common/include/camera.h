@@ -36,6 +36,10 @@ namespace OpenGL {
             [[nodiscard]] const glm::mat4& GetPerspectiveTransform();
             [[nodiscard]] const glm::mat4& GetViewTransform();
 
+            // World space planes of the view frustum (left, right, bottom, top, near, far), as (normal, distance) with
+            // normals facing into the frustum. Points inside the frustum are on the positive side of every plane.
+            [[nodiscard]] std::array<glm::vec4, 6> GetFrustumPlanes();
+
             [[nodiscard]] const glm::vec3& GetForwardVector() const;
             [[nodiscard]] const glm::vec3& GetUpVector() const;
 
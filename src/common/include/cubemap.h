@@ -0,0 +1,52 @@
+
+#ifndef OPENGL_SAMPLES_CUBEMAP_H
+#define OPENGL_SAMPLES_CUBEMAP_H
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Cubemap texture with a full mip chain, loaded from six (square, equally sized) images ordered +X, -X, +Y, -Y, +Z, -Z.
+    // Faces are read and decoded in parallel, mip levels are generated on the CPU.
+    // The texture data is compressed to S3TC (DXT1) by the driver when supported, and cached on disk keyed by a hash of
+    // the source images. Subsequent loads of the same images upload the cached data directly, skipping decoding,
+    // mip generation, and compression.
+    class Cubemap {
+        public:
+            // An empty cache directory disables the disk cache.
+            // Throws std::runtime_error if any of the faces fail to load.
+            Cubemap(const std::vector<std::string>& faces, const std::string& cacheDirectory);
+            ~Cubemap();
+
+            [[nodiscard]] GLuint GetTexture() const;
+
+            // Dimensions of the base level.
+            [[nodiscard]] int GetSize() const;
+            [[nodiscard]] int GetNumLevels() const;
+
+            [[nodiscard]] bool IsCompressed() const;
+            [[nodiscard]] bool IsLoadedFromCache() const;
+
+            // Size (in bytes) of all faces and mip levels.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+        private:
+            // Texture data of every face, per mip level.
+            typedef std::vector<std::array<std::vector<unsigned char>, 6>> LevelData;
+
+            [[nodiscard]] bool ReadCache(const std::string& filepath, LevelData& levels);
+            void WriteCache(const std::string& filepath, const LevelData& levels) const;
+
+            // Reads back the data compressed by the driver, if the texture was uploaded from uncompressed source data.
+            void Upload(LevelData& levels);
+
+            GLuint texture_;
+            GLenum internalFormat_;
+            int size_;
+            bool isLoadedFromCache_;
+            std::size_t memoryUsage_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_CUBEMAP_H
@@ -0,0 +1,80 @@
+
+#ifndef OPENGL_SAMPLES_FRAME_RECORDER_H
+#define OPENGL_SAMPLES_FRAME_RECORDER_H
+
+#include "pch.h"
+#include "readback.h"
+#include "thread_pool.h"
+
+namespace OpenGL {
+
+    // Streams a sequence of frames to disk. Frames are read back asynchronously and handed to a writer thread through
+    // a bounded queue, so memory usage stays constant no matter how far behind the disk falls.
+    class FrameRecorder {
+        public:
+            enum class Format {
+                PNGSequence, // '<filepath>/frame_000000.png', ...
+                Y4M          // '<filepath>.y4m', uncompressed 4:4:4 YUV video
+            };
+
+            // What to do with a captured frame when the writer queue (or the readback ring) is full.
+            enum class OverflowPolicy {
+                Block, // Stall the render thread until there is space (back-pressure).
+                Drop   // Discard the frame and count it as dropped.
+            };
+
+            FrameRecorder();
+            ~FrameRecorder();
+
+            // Returns false if a recording is already in progress or the output could not be opened.
+            [[nodiscard]] bool Start(const std::string& filepath, Format format, int width, int height, int framesPerSecond, OverflowPolicy policy, std::size_t maxQueuedFrames);
+
+            // Writes out all frames that were captured so far before closing the recording.
+            void Stop();
+
+            // Captures the current contents of an RGBA8-readable texture as the next frame of the recording.
+            // Frames with a size different to the one the recording was started with are dropped.
+            void Capture(GLuint texture, int width, int height);
+
+            // Hands completed readbacks off to the writer thread. Should be called once per frame.
+            void Update();
+
+            [[nodiscard]] bool IsRecording() const;
+
+            [[nodiscard]] int GetNumFramesCaptured() const;
+            [[nodiscard]] int GetNumFramesWritten() const;
+            [[nodiscard]] int GetNumFramesDropped() const;
+
+            // Number of frames waiting on the GPU or in the writer queue, and the upper bound on memory they occupy.
+            [[nodiscard]] int GetNumFramesPending() const;
+            [[nodiscard]] std::size_t GetMaximumMemoryUsage() const;
+
+        private:
+            void Submit(std::vector<unsigned char> pixels);
+            // Returns false if the frame could not be written (reported on stderr).
+            [[nodiscard]] bool WriteFrame(const std::vector<unsigned char>& pixels, int frameIndex);
+
+            AsyncReadback readback_;
+            std::unique_ptr<ThreadPool> writer_;
+
+            std::string filepath_;
+            Format format_;
+            OverflowPolicy policy_;
+            std::size_t maxQueuedFrames_;
+
+            int width_;
+            int height_;
+
+            std::ofstream video_;
+            std::vector<unsigned char> planes_; // Y4M conversion scratch buffer, only touched by the writer thread.
+
+            bool isRecording_;
+            int numFramesCaptured_;
+            int numFramesSubmitted_;
+            std::atomic<int> numFramesWritten_;
+            int numFramesDropped_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_FRAME_RECORDER_H
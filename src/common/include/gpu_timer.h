@@ -0,0 +1,55 @@
+
+#ifndef OPENGL_SAMPLES_GPU_TIMER_H
+#define OPENGL_SAMPLES_GPU_TIMER_H
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Measures the GPU execution time of a range of commands with timestamp queries.
+    // Queries are kept in a small ring and only read once their results are available (typically a frame or two later),
+    // so timing never stalls the pipeline. Timestamps (instead of GL_TIME_ELAPSED) allow timers to overlap / nest.
+    class GPUTimer {
+        public:
+            explicit GPUTimer(unsigned numQueries = 4);
+            ~GPUTimer();
+
+            // Measurements are skipped if all queries in the ring are still waiting on results.
+            void Begin();
+            void End();
+
+            // Polls outstanding queries. Returns true if a new measurement became available.
+            bool Update();
+
+            // Discards all measurements that are still in flight, for example after a change in workload.
+            void Reset();
+
+            // Most recent measurement.
+            [[nodiscard]] float GetElapsedMilliseconds() const;
+
+            // Exponential moving average of all measurements.
+            [[nodiscard]] float GetAverageMilliseconds() const;
+
+            // Number of measurements since construction or the last call to Reset().
+            [[nodiscard]] int GetNumMeasurements() const;
+
+        private:
+            struct Query {
+                GLuint start;
+                GLuint end;
+                bool discard;
+            };
+
+            std::vector<Query> queries_;
+            std::queue<unsigned> inFlight_; // Indices into queries_, in submission order.
+            unsigned next_;
+            bool isTiming_;
+
+            float elapsed_;
+            float average_;
+            int numMeasurements_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_GPU_TIMER_H
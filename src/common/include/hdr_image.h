@@ -0,0 +1,41 @@
+
+#ifndef OPENGL_SAMPLES_HDR_IMAGE_H
+#define OPENGL_SAMPLES_HDR_IMAGE_H
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    enum class HDRFormat {
+        OpenEXRHalf,  // .exr, 16-bit floating point channels
+        OpenEXRFloat, // .exr, 32-bit floating point channels
+        PFM,          // .pfm, RGB only
+        Radiance      // .hdr, RGBE encoded (stb_image_write)
+    };
+
+    // Interleaved floating point image data. Rows are ordered bottom to top, matching data read back from OpenGL.
+    struct HDRLayer {
+        // Layers are written out as '<name>.R', '<name>.G', ... channels. The unnamed layer is the main (beauty) image.
+        std::string name;
+        const float* data;
+
+        // Number of interleaved components in 'data', only the first three (RGB) are written out.
+        int numComponents;
+    };
+
+    [[nodiscard]] const char* GetHDRFormatExtension(HDRFormat format);
+
+    // Writes the given layers to '<filepath>.<extension>' one scanline at a time, so no second full-size copy of the
+    // image is made. Only OpenEXR supports more than one layer (written as a single-part, multi-layer file), the
+    // remaining formats only write out the first layer.
+    // Returns whether the image was written successfully.
+    [[nodiscard]] bool WriteHDRImage(const std::string& filepath, HDRFormat format, int width, int height, const std::vector<HDRLayer>& layers);
+
+    // Reads a (color, little endian) PFM image, such as the ones written by WriteHDRImage. Unlike WriteHDRImage, the
+    // filepath includes the extension. Data is RGB, rows ordered bottom to top.
+    // Returns whether the image was read successfully.
+    [[nodiscard]] bool ReadPFMImage(const std::string& filepath, int& width, int& height, std::vector<float>& data);
+
+}
+
+#endif //OPENGL_SAMPLES_HDR_IMAGE_H
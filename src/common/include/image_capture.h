@@ -0,0 +1,49 @@
+
+#ifndef OPENGL_SAMPLES_IMAGE_CAPTURE_H
+#define OPENGL_SAMPLES_IMAGE_CAPTURE_H
+
+#include "pch.h"
+#include "readback.h"
+#include "thread_pool.h"
+#include "hdr_image.h"
+
+namespace OpenGL {
+
+    // Saves the contents of textures to disk without stalling the render thread.
+    // Pixels are read back asynchronously and handed off to a background thread for encoding and disk writes.
+    class ImageCapture {
+        public:
+            ImageCapture();
+            ~ImageCapture();
+
+            // Queues a capture of the given texture, saved as both '<filepath>.png' and '<filepath>.jpg'.
+            // Returns false if too many captures are already in flight.
+            [[nodiscard]] bool Capture(GLuint texture, int width, int height, const std::string& filepath);
+
+            // Queues a capture of the raw floating point RGB(A) contents of the given texture (no tonemapping or
+            // quantization), saved as '<filepath>.<extension>' in the given format.
+            // Returns false if too many captures are already in flight.
+            [[nodiscard]] bool CaptureHDR(GLuint texture, int width, int height, const std::string& filepath, HDRFormat format);
+
+            // Hands completed readbacks off to the writer thread. Should be called once per frame.
+            void Update();
+
+            // Blocks until all outstanding captures have been written to disk.
+            void Flush();
+
+            // Number of captures either waiting on the GPU or being written to disk.
+            [[nodiscard]] int GetNumPendingCaptures() const;
+
+        private:
+            AsyncReadback readback_;
+
+            // Decremented by queued writer tasks, so it has to outlive the writer (members are destroyed in reverse).
+            std::atomic<int> numPendingCaptures_;
+
+            // Destroyed first, its destructor finishes the queued writes (the only place shutdown waits for them).
+            ThreadPool writer_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_IMAGE_CAPTURE_H
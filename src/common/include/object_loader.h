@@ -24,6 +24,9 @@ namespace OpenGL {
 
             [[nodiscard]] Mesh LoadFromFile(const std::string& filename);
 
+            // Forgets all loaded meshes, the next load of a file reads it from disk again.
+            void ClearCache();
+
         private:
             ObjectLoader();
             ~ObjectLoader();
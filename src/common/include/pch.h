@@ -22,8 +22,10 @@
 #include <memory>
 #include <algorithm>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 #include <cstdio>
+#include <cstring>
 #include <variant>
 
 // Third-party
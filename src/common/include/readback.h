@@ -0,0 +1,58 @@
+
+#ifndef OPENGL_SAMPLES_READBACK_H
+#define OPENGL_SAMPLES_READBACK_H
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Asynchronous GPU -> CPU transfers (of textures or buffers) through a ring of pixel pack buffers.
+    // Each request is fenced and only mapped once the GPU has finished the copy, typically one or two frames later,
+    // so reading back data never stalls the pipeline.
+    class AsyncReadback {
+        public:
+            // Receives a copy of the transferred data.
+            typedef std::function<void(std::vector<unsigned char> data)> Callback;
+
+            explicit AsyncReadback(unsigned numBuffers = 3);
+            ~AsyncReadback();
+
+            // Queues a read of a texture level in the given client format / type.
+            // Returns false if all pixel pack buffers are currently in flight.
+            [[nodiscard]] bool ReadTexture(GLuint texture, GLint level, int width, int height, GLenum format, GLenum type, std::size_t size, Callback onComplete);
+
+            // Queues a read of a range of a buffer object.
+            // Returns false if all pixel pack buffers are currently in flight.
+            [[nodiscard]] bool ReadBuffer(GLuint buffer, std::size_t offset, std::size_t size, Callback onComplete);
+
+            // Polls outstanding transfers and invokes the callbacks of the ones that have completed.
+            // Should be called once per frame.
+            void Update();
+
+            // Blocks until all outstanding transfers have completed.
+            void Flush();
+
+            [[nodiscard]] bool IsBusy() const;
+            [[nodiscard]] unsigned GetNumRequestsInFlight() const;
+
+        private:
+            struct Request {
+                GLuint buffer;
+                std::size_t capacity;
+                std::size_t size;
+                GLsync fence;
+                Callback onComplete;
+            };
+
+            // Returns the request slot the next transfer should be recorded in, reallocating its storage if necessary.
+            [[nodiscard]] Request* Acquire(std::size_t size);
+            void Complete(Request& request);
+
+            std::vector<Request> requests_;
+            std::queue<unsigned> inFlight_; // Indices into requests_, in submission order.
+            unsigned next_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_READBACK_H
@@ -10,6 +10,9 @@ namespace OpenGL {
         public:
             typedef std::pair<std::string, GLenum> ShaderComponent;
 
+            // Preprocessor definition (name -> value) injected after the #version directive of every shader component.
+            typedef std::pair<std::string, std::string> ShaderDefine;
+
             // Compiles all shader components and returns a linked program.
             // Throws std::runtime_error on compilation error.
 
@@ -20,8 +23,12 @@ namespace OpenGL {
             // .vert - Vertex
             // .frag - Fragment
             // .geom - Geometry
+            // .comp - Compute
             Shader(std::string name, std::initializer_list<std::string> shaderComponents);
 
+            // Deduces shader type from file extension, compiles every component with the given preprocessor definitions.
+            Shader(std::string name, std::initializer_list<std::string> shaderComponents, std::vector<ShaderDefine> defines);
+
             ~Shader();
 
             void Bind() const;
@@ -30,19 +37,25 @@ namespace OpenGL {
             template <typename DataType>
             void SetUniform(const std::string& uniformName, DataType data);
 
+            // Local work group size of a compute shader.
+            [[nodiscard]] glm::ivec3 GetWorkGroupSize() const;
+
         private:
             template <typename DataType>
             void SetUniformData(GLuint uniformLocation, DataType data) const;
 
+            [[nodiscard]] std::vector<ShaderComponent> ComponentsFromExtensions(std::initializer_list<std::string> shaderComponents) const;
             void CreateShader(const std::vector<ShaderComponent>& components);
 
             [[nodiscard]] std::string ReadShaderFile(const std::string& filepath) const;
+            [[nodiscard]] std::string InjectDefines(const std::string& source) const;
             [[nodiscard]] GLenum ShaderTypeFromExtension(const std::string& extension) const;
 
             [[nodiscard]] std::string ShaderTypeToString(GLenum shaderType) const;
             [[nodiscard]] GLuint CompileShaderComponent(const std::pair<std::string, GLenum>& shaderComponent) const;
 
             std::string name_;
+            std::vector<ShaderDefine> defines_;
             GLuint program_;
             std::unordered_map<std::string, GLint> uniformLocations_;
     };
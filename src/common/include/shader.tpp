@@ -27,6 +27,10 @@ namespace OpenGL {
         if constexpr (std::is_same_v<DataType, int> || std::is_same_v<DataType, bool>) {
             glUniform1i(uniformLocation, data);
         }
+        // UINT
+        else if constexpr (std::is_same_v<DataType, unsigned>) {
+            glUniform1ui(uniformLocation, data);
+        }
         // FLOAT
         else if constexpr (std::is_same_v<DataType, float>) {
             glUniform1f(uniformLocation, data);
@@ -35,6 +39,10 @@ namespace OpenGL {
         else if constexpr (std::is_same_v<DataType, glm::vec2>) {
             glUniform2fv(uniformLocation, 1, glm::value_ptr(data));
         }
+        // IVEC2
+        else if constexpr (std::is_same_v<DataType, glm::ivec2>) {
+            glUniform2iv(uniformLocation, 1, glm::value_ptr(data));
+        }
         // VEC3
         else if constexpr (std::is_same_v<DataType, glm::vec3>) {
             glUniform3fv(uniformLocation, 1, glm::value_ptr(data));
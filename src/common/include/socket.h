@@ -0,0 +1,62 @@
+
+#ifndef OPENGL_SAMPLES_SOCKET_H
+#define OPENGL_SAMPLES_SOCKET_H
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Minimal blocking TCP socket, restricted to the loopback interface (127.0.0.1).
+    // Used for communication between processes on the same machine, data is sent in native byte order.
+    class Socket {
+        public:
+#ifdef _WIN32
+            typedef std::uintptr_t Handle; // SOCKET
+#else
+            typedef int Handle; // File descriptor.
+#endif
+
+            // Creates an invalid (closed) socket.
+            Socket();
+            ~Socket();
+
+            Socket(Socket&& other) noexcept;
+            Socket& operator=(Socket&& other) noexcept;
+
+            Socket(const Socket&) = delete;
+            Socket& operator=(const Socket&) = delete;
+
+            // Returns an invalid socket on failure.
+            // A port of 0 listens on any free port, see GetPort().
+            [[nodiscard]] static Socket Listen(int port);
+            [[nodiscard]] static Socket Connect(int port);
+
+            // Waits for activity on the given sockets for up to 'timeout' milliseconds (-1 waits indefinitely).
+            // Returns, per socket, whether a call to Accept() / Receive() will not block. Sockets with a closed or broken
+            // connection are reported as well, Receive() on them fails immediately.
+            [[nodiscard]] static std::vector<bool> Poll(const std::vector<const Socket*>& sockets, int timeout);
+
+            // Returns an invalid socket on failure.
+            [[nodiscard]] Socket Accept() const;
+
+            // Sends / receives exactly 'size' bytes, blocking until done.
+            // Returns false if the connection was closed or broken, after which the socket should be closed.
+            [[nodiscard]] bool Send(const void* data, std::size_t size) const;
+            [[nodiscard]] bool Receive(void* data, std::size_t size) const;
+
+            void Close();
+
+            [[nodiscard]] bool IsValid() const;
+
+            // Local port the socket is bound to.
+            [[nodiscard]] int GetPort() const;
+
+        private:
+            explicit Socket(Handle handle);
+
+            Handle handle_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_SOCKET_H
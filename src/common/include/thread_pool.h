@@ -0,0 +1,50 @@
+
+#ifndef OPENGL_SAMPLES_THREAD_POOL_H
+#define OPENGL_SAMPLES_THREAD_POOL_H
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Fixed set of worker threads consuming tasks from a shared queue.
+    class ThreadPool {
+        public:
+            typedef std::function<void()> Task;
+
+            // A capacity of 0 leaves the task queue unbounded.
+            explicit ThreadPool(unsigned numThreads = std::thread::hardware_concurrency(), std::size_t capacity = 0);
+
+            // Finishes all queued tasks before joining the worker threads.
+            ~ThreadPool();
+
+            // Blocks while the task queue is full.
+            void Submit(Task task);
+
+            // Returns false (and drops the task) if the task queue is full.
+            [[nodiscard]] bool TrySubmit(Task task);
+
+            // Blocks until all submitted tasks have finished executing.
+            void Wait();
+
+            // Number of tasks that are queued or currently executing.
+            [[nodiscard]] std::size_t GetNumPendingTasks() const;
+            [[nodiscard]] unsigned GetNumThreads() const;
+
+        private:
+            void Run();
+
+            std::vector<std::thread> threads_;
+            std::queue<Task> tasks_;
+            std::size_t capacity_;
+            std::size_t numActiveTasks_;
+            bool isRunning_;
+
+            mutable std::mutex mutex_;
+            std::condition_variable taskAvailable_;
+            std::condition_variable spaceAvailable_;
+            std::condition_variable tasksFinished_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_THREAD_POOL_H
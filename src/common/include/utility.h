@@ -14,6 +14,14 @@ namespace Utilities {
     [[nodiscard]] std::string GetAssetExtension(std::string path);
     [[nodiscard]] std::vector<std::string> GetFiles(std::string path);
 
+    // Interleaves the bits of the (16-bit) coordinates, x occupying the even bits.
+    // Sorting by the result gives a Z-order curve, which keeps neighbouring coordinates close together.
+    [[nodiscard]] unsigned EncodeMorton2D(unsigned x, unsigned y);
+
+    // 64-bit FNV-1a hash of the given bytes. Pass the result of a previous call as 'hash' to hash data incrementally.
+    // Not cryptographically secure, intended for content-addressed caching.
+    [[nodiscard]] std::uint64_t HashFNV1a(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ull);
+
 }
 
 #endif //OPENGL_SAMPLES_UTILITY_H
@@ -106,6 +106,27 @@ namespace OpenGL {
         return viewTransform_;
     }
 
+    std::array<glm::vec4, 6> Camera::GetFrustumPlanes() {
+        const glm::mat4& transform = GetCameraTransform();
+
+        // Rows of the view projection matrix (glm matrices are column major).
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; ++i) {
+            rows[i] = glm::vec4(transform[0][i], transform[1][i], transform[2][i], transform[3][i]);
+        }
+
+        // Clip space bounds -w <= x, y, z <= w.
+        std::array<glm::vec4, 6> planes = { rows[3] + rows[0], rows[3] - rows[0],
+                                            rows[3] + rows[1], rows[3] - rows[1],
+                                            rows[3] + rows[2], rows[3] - rows[2] };
+
+        for (glm::vec4& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        return planes;
+    }
+
     const glm::vec3 &Camera::GetForwardVector() const {
         return lookAtDirection_;
     }
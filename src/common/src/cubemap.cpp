@@ -0,0 +1,401 @@
+
+#include "cubemap.h"
+#include "thread_pool.h"
+#include "utility.h"
+
+// Provided by GL_EXT_texture_compression_s3tc, which is not part of the core profile.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace OpenGL {
+
+    namespace {
+
+        const std::uint32_t cacheMagic = 0x45425543u; // 'CUBE'
+        const std::uint32_t cacheVersion = 1u; // Increment when the layout of the cache file changes.
+
+        std::vector<unsigned char> ReadFile(const std::string& filepath) {
+            std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+            if (!stream.is_open()) {
+                return { };
+            }
+
+            std::streamsize size = stream.tellg();
+            if (size <= 0) {
+                return { };
+            }
+
+            std::vector<unsigned char> contents(static_cast<std::size_t>(size));
+            stream.seekg(0, std::ios::beg);
+            if (!stream.read(reinterpret_cast<char*>(contents.data()), size)) {
+                return { };
+            }
+
+            return contents;
+        }
+
+        template <typename T>
+        void WriteBinary(std::ofstream& stream, T value) {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        bool IsExtensionSupported(const std::string& extension) {
+            GLint numExtensions = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+            for (GLint i = 0; i < numExtensions; ++i) {
+                const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+                if (name && extension == name) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        int CalculateNumLevels(int size) {
+            int numLevels = 1;
+            while (size > 1) {
+                size /= 2;
+                ++numLevels;
+            }
+            return numLevels;
+        }
+
+        std::size_t GetLevelDataSize(GLenum internalFormat, int size) {
+            if (internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) {
+                // 8 bytes per 4x4 block.
+                std::size_t numBlocks = static_cast<std::size_t>((size + 3) / 4);
+                return numBlocks * numBlocks * 8;
+            }
+
+            return static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * 3;
+        }
+
+        // 2x2 box filter of tightly packed RGB data.
+        std::vector<unsigned char> Downsample(const std::vector<unsigned char>& source, int sourceSize) {
+            int size = std::max(sourceSize / 2, 1);
+            std::vector<unsigned char> result(static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * 3);
+
+            for (int y = 0; y < size; ++y) {
+                // Odd dimensions clamp to the last row / column.
+                int y0 = std::min(2 * y, sourceSize - 1) * sourceSize;
+                int y1 = std::min(2 * y + 1, sourceSize - 1) * sourceSize;
+
+                for (int x = 0; x < size; ++x) {
+                    int x0 = std::min(2 * x, sourceSize - 1);
+                    int x1 = std::min(2 * x + 1, sourceSize - 1);
+
+                    for (int c = 0; c < 3; ++c) {
+                        unsigned sum = source[(y0 + x0) * 3 + c] + source[(y0 + x1) * 3 + c] + source[(y1 + x0) * 3 + c] + source[(y1 + x1) * 3 + c];
+                        result[(y * size + x) * 3 + c] = static_cast<unsigned char>((sum + 2u) / 4u);
+                    }
+                }
+            }
+
+            return result;
+        }
+
+    }
+
+    Cubemap::Cubemap(const std::vector<std::string>& faces, const std::string& cacheDirectory) : texture_(0),
+                                                                                                 internalFormat_(GL_RGB8),
+                                                                                                 size_(0),
+                                                                                                 isLoadedFromCache_(false),
+                                                                                                 memoryUsage_(0) {
+        if (faces.size() != 6) {
+            throw std::runtime_error("Cubemap requires 6 faces, " + std::to_string(faces.size()) + " provided.");
+        }
+
+        ThreadPool threadPool(6);
+
+        // Encoded file contents are needed for both the cache key and decoding.
+        std::array<std::vector<unsigned char>, 6> files;
+        for (unsigned i = 0; i < 6; ++i) {
+            threadPool.Submit([&faces, &files, i]() {
+                files[i] = ReadFile(faces[i]);
+            });
+        }
+        threadPool.Wait();
+
+        std::uint64_t hash = Utilities::HashFNV1a(&cacheVersion, sizeof(cacheVersion));
+        for (unsigned i = 0; i < 6; ++i) {
+            if (files[i].empty()) {
+                throw std::runtime_error("Failed to read cubemap face: " + faces[i]);
+            }
+
+            hash = Utilities::HashFNV1a(files[i].data(), files[i].size(), hash);
+        }
+
+        std::string cacheFilepath;
+        if (!cacheDirectory.empty()) {
+            char filename[32];
+            std::snprintf(filename, sizeof(filename), "%016llx.cubemap", static_cast<unsigned long long>(hash));
+            cacheFilepath = (std::filesystem::path(Utilities::ConvertToNativeSeparators(cacheDirectory)) / filename).string();
+        }
+
+        LevelData levels;
+        if (!cacheFilepath.empty() && ReadCache(cacheFilepath, levels)) {
+            isLoadedFromCache_ = true;
+            Upload(levels);
+            return;
+        }
+
+        // Decode faces and generate their mip chains in parallel.
+        std::array<int, 6> faceSizes { };
+        std::array<std::vector<std::vector<unsigned char>>, 6> faceLevels;
+
+        for (unsigned i = 0; i < 6; ++i) {
+            threadPool.Submit([&files, &faceSizes, &faceLevels, i]() {
+                int width;
+                int height;
+                int channels;
+                unsigned char* data = stbi_load_from_memory(files[i].data(), static_cast<int>(files[i].size()), &width, &height, &channels, 3);
+
+                // Faces must be square, failures are reported on the main thread.
+                if (!data || width != height) {
+                    stbi_image_free(data);
+                    return;
+                }
+
+                std::vector<std::vector<unsigned char>>& levels = faceLevels[i];
+                levels.emplace_back(data, data + static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 3);
+                stbi_image_free(data);
+
+                for (int size = width; size > 1; size = std::max(size / 2, 1)) {
+                    levels.push_back(Downsample(levels.back(), size));
+                }
+
+                faceSizes[i] = width;
+            });
+        }
+        threadPool.Wait();
+
+        size_ = faceSizes[0];
+        for (unsigned i = 0; i < 6; ++i) {
+            if (faceSizes[i] == 0) {
+                throw std::runtime_error("Failed to decode cubemap face (faces must be square): " + faces[i]);
+            }
+            if (faceSizes[i] != size_) {
+                throw std::runtime_error("Cubemap face dimensions do not match: " + faces[i]);
+            }
+        }
+
+        levels.resize(faceLevels[0].size());
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+            for (unsigned i = 0; i < 6; ++i) {
+                levels[level][i] = std::move(faceLevels[i][level]);
+            }
+        }
+
+        // The driver compresses the data on upload.
+        internalFormat_ = IsExtensionSupported("GL_EXT_texture_compression_s3tc") ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGB8;
+        Upload(levels);
+
+        if (!cacheFilepath.empty()) {
+            WriteCache(cacheFilepath, levels);
+        }
+    }
+
+    Cubemap::~Cubemap() {
+        glDeleteTextures(1, &texture_);
+    }
+
+    GLuint Cubemap::GetTexture() const {
+        return texture_;
+    }
+
+    int Cubemap::GetSize() const {
+        return size_;
+    }
+
+    int Cubemap::GetNumLevels() const {
+        return CalculateNumLevels(size_);
+    }
+
+    bool Cubemap::IsCompressed() const {
+        return internalFormat_ == GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+
+    bool Cubemap::IsLoadedFromCache() const {
+        return isLoadedFromCache_;
+    }
+
+    std::size_t Cubemap::GetMemoryUsage() const {
+        return memoryUsage_;
+    }
+
+    bool Cubemap::ReadCache(const std::string& filepath, LevelData& levels) {
+        std::vector<unsigned char> contents = ReadFile(filepath);
+        std::size_t offset = 0;
+
+        auto read = [&contents, &offset](void* destination, std::size_t size) -> bool {
+            if (contents.size() - offset < size) {
+                return false;
+            }
+
+            std::memcpy(destination, contents.data() + offset, size);
+            offset += size;
+            return true;
+        };
+
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t internalFormat;
+        std::int32_t size;
+        std::int32_t numLevels;
+
+        if (!read(&magic, sizeof(magic)) || !read(&version, sizeof(version)) || !read(&internalFormat, sizeof(internalFormat)) ||
+            !read(&size, sizeof(size)) || !read(&numLevels, sizeof(numLevels))) {
+            return false;
+        }
+
+        if (magic != cacheMagic || version != cacheVersion || size <= 0 || numLevels != CalculateNumLevels(size)) {
+            return false;
+        }
+
+        // Data cached on a machine with different capabilities.
+        if (internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) {
+            if (!IsExtensionSupported("GL_EXT_texture_compression_s3tc")) {
+                return false;
+            }
+        }
+        else if (internalFormat != GL_RGB8) {
+            return false;
+        }
+
+        levels.resize(numLevels);
+        for (int level = 0; level < numLevels; ++level) {
+            std::size_t levelDataSize = GetLevelDataSize(internalFormat, std::max(size >> level, 1));
+
+            for (std::vector<unsigned char>& face : levels[level]) {
+                std::uint64_t faceDataSize;
+                if (!read(&faceDataSize, sizeof(faceDataSize)) || faceDataSize != levelDataSize) {
+                    return false;
+                }
+
+                face.resize(levelDataSize);
+                if (!read(face.data(), levelDataSize)) {
+                    return false;
+                }
+            }
+        }
+
+        internalFormat_ = internalFormat;
+        size_ = size;
+        return true;
+    }
+
+    void Cubemap::WriteCache(const std::string& filepath, const LevelData& levels) const {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), error);
+
+        // Written to a temporary file first, so an interrupted write never leaves behind a partial cache entry.
+        std::string temporaryFilepath = filepath + ".tmp";
+
+        {
+            std::ofstream stream(temporaryFilepath, std::ios::binary);
+            if (!stream.is_open()) {
+                std::cerr << "Failed to create cubemap cache file: " << filepath << std::endl;
+                return;
+            }
+
+            WriteBinary<std::uint32_t>(stream, cacheMagic);
+            WriteBinary<std::uint32_t>(stream, cacheVersion);
+            WriteBinary<std::uint32_t>(stream, internalFormat_);
+            WriteBinary<std::int32_t>(stream, size_);
+            WriteBinary<std::int32_t>(stream, static_cast<std::int32_t>(levels.size()));
+
+            for (const std::array<std::vector<unsigned char>, 6>& level : levels) {
+                for (const std::vector<unsigned char>& face : level) {
+                    WriteBinary<std::uint64_t>(stream, face.size());
+                    stream.write(reinterpret_cast<const char*>(face.data()), static_cast<std::streamsize>(face.size()));
+                }
+            }
+
+            if (!stream.good()) {
+                std::cerr << "Failed to write cubemap cache file: " << filepath << std::endl;
+                return;
+            }
+        }
+
+        // std::filesystem::rename does not replace existing files on all platforms.
+        std::filesystem::remove(filepath, error);
+        std::filesystem::rename(temporaryFilepath, filepath, error);
+        if (error) {
+            std::cerr << "Failed to write cubemap cache file: " << filepath << std::endl;
+        }
+    }
+
+    void Cubemap::Upload(LevelData& levels) {
+        glGenTextures(1, &texture_);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture_);
+
+        // Rows of RGB data are tightly packed.
+        GLint unpackAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        bool isCompressedData = isLoadedFromCache_ && IsCompressed();
+
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+            int size = std::max(size_ >> level, 1);
+
+            for (unsigned i = 0; i < 6; ++i) {
+                const std::vector<unsigned char>& data = levels[level][i];
+                GLenum target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + i;
+
+                if (isCompressedData) {
+                    glCompressedTexImage2D(target, static_cast<GLint>(level), internalFormat_, size, size, 0, static_cast<GLsizei>(data.size()), data.data());
+                }
+                else {
+                    glTexImage2D(target, static_cast<GLint>(level), static_cast<GLint>(internalFormat_), size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, data.data());
+                }
+            }
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size()) - 1);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+        if (!isLoadedFromCache_ && IsCompressed()) {
+            GLint isCompressed = GL_FALSE;
+            glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_COMPRESSED, &isCompressed);
+
+            if (isCompressed) {
+                // Replace the source data with the compressed result, for the cache.
+                for (std::size_t level = 0; level < levels.size(); ++level) {
+                    for (unsigned i = 0; i < 6; ++i) {
+                        GLenum target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + i;
+
+                        GLint compressedSize = 0;
+                        glGetTexLevelParameteriv(target, static_cast<GLint>(level), GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
+
+                        levels[level][i].resize(static_cast<std::size_t>(compressedSize));
+                        glGetCompressedTexImage(target, static_cast<GLint>(level), levels[level][i].data());
+                    }
+                }
+            }
+            else {
+                // Driver accepted the format but stored the data uncompressed.
+                internalFormat_ = GL_RGB8;
+            }
+        }
+
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        memoryUsage_ = 0;
+        for (const std::array<std::vector<unsigned char>, 6>& level : levels) {
+            for (const std::vector<unsigned char>& face : level) {
+                memoryUsage_ += face.size();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,230 @@
+
+#include "frame_recorder.h"
+
+namespace OpenGL {
+
+    FrameRecorder::FrameRecorder() : readback_(3),
+                                     writer_(nullptr),
+                                     format_(Format::PNGSequence),
+                                     policy_(OverflowPolicy::Block),
+                                     maxQueuedFrames_(0),
+                                     width_(0),
+                                     height_(0),
+                                     isRecording_(false),
+                                     numFramesCaptured_(0),
+                                     numFramesSubmitted_(0),
+                                     numFramesWritten_(0),
+                                     numFramesDropped_(0) {
+        // Frames are read back from OpenGL bottom row first.
+        stbi_flip_vertically_on_write(true);
+    }
+
+    FrameRecorder::~FrameRecorder() {
+        // Joins the writer thread, finishing any queued frames.
+        writer_.reset();
+    }
+
+    bool FrameRecorder::Start(const std::string& filepath, Format format, int width, int height, int framesPerSecond, OverflowPolicy policy, std::size_t maxQueuedFrames) {
+        if (isRecording_ || width <= 0 || height <= 0) {
+            return false;
+        }
+
+        filepath_ = filepath;
+        format_ = format;
+        policy_ = policy;
+        maxQueuedFrames_ = std::max(maxQueuedFrames, static_cast<std::size_t>(1));
+        width_ = width;
+        height_ = height;
+
+        if (format_ == Format::PNGSequence) {
+            if (!std::filesystem::exists(filepath_)) {
+                // Create output directory if it doesn't exist.
+                std::filesystem::create_directories(filepath_);
+            }
+        }
+        else {
+            std::filesystem::path directory = std::filesystem::path(filepath_).parent_path();
+            if (!directory.empty() && !std::filesystem::exists(directory)) {
+                // Create output directory if it doesn't exist.
+                std::filesystem::create_directories(directory);
+            }
+
+            video_.open(filepath_ + ".y4m", std::ios::binary);
+            if (!video_.is_open()) {
+                return false;
+            }
+
+            // https://wiki.multimedia.cx/index.php/YUV4MPEG2
+            video_ << "YUV4MPEG2 W" << width_ << " H" << height_ << " F" << std::max(framesPerSecond, 1) << ":1 Ip A1:1 C444\n";
+            planes_.resize(static_cast<std::size_t>(width_) * height_ * 3);
+        }
+
+        // A single writer thread keeps frames in order. The queue bound (plus the readback ring) caps memory usage.
+        writer_ = std::make_unique<ThreadPool>(1, maxQueuedFrames_);
+
+        isRecording_ = true;
+        numFramesCaptured_ = 0;
+        numFramesSubmitted_ = 0;
+        numFramesWritten_ = 0;
+        numFramesDropped_ = 0;
+        return true;
+    }
+
+    void FrameRecorder::Stop() {
+        if (!isRecording_) {
+            return;
+        }
+
+        // Frames still in flight belong to this recording.
+        readback_.Flush();
+        writer_.reset();
+
+        if (video_.is_open()) {
+            video_.close();
+        }
+        planes_.clear();
+        planes_.shrink_to_fit();
+
+        isRecording_ = false;
+    }
+
+    void FrameRecorder::Capture(GLuint texture, int width, int height) {
+        if (!isRecording_) {
+            return;
+        }
+
+        if (width != width_ || height != height_) {
+            ++numFramesDropped_;
+            return;
+        }
+
+        if (readback_.IsBusy()) {
+            if (policy_ == OverflowPolicy::Drop) {
+                ++numFramesDropped_;
+                return;
+            }
+
+            // Wait on the GPU to free up a pixel pack buffer.
+            readback_.Flush();
+        }
+
+        std::size_t size = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * 4;
+        bool queued = readback_.ReadTexture(texture, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, size, [this](std::vector<unsigned char> pixels) {
+            Submit(std::move(pixels));
+        });
+
+        if (queued) {
+            ++numFramesCaptured_;
+        }
+    }
+
+    void FrameRecorder::Update() {
+        if (isRecording_) {
+            readback_.Update();
+        }
+    }
+
+    bool FrameRecorder::IsRecording() const {
+        return isRecording_;
+    }
+
+    int FrameRecorder::GetNumFramesCaptured() const {
+        return numFramesCaptured_;
+    }
+
+    int FrameRecorder::GetNumFramesWritten() const {
+        return numFramesWritten_;
+    }
+
+    int FrameRecorder::GetNumFramesDropped() const {
+        return numFramesDropped_;
+    }
+
+    int FrameRecorder::GetNumFramesPending() const {
+        int numPending = static_cast<int>(readback_.GetNumRequestsInFlight());
+        if (writer_) {
+            numPending += static_cast<int>(writer_->GetNumPendingTasks());
+        }
+        return numPending;
+    }
+
+    std::size_t FrameRecorder::GetMaximumMemoryUsage() const {
+        // Readback ring + queued frames + the frame currently being written.
+        std::size_t frameSize = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * 4;
+        return frameSize * (3 + maxQueuedFrames_ + 1) + planes_.capacity();
+    }
+
+    void FrameRecorder::Submit(std::vector<unsigned char> pixels) {
+        // Frames are numbered in submission order, dropped frames leave no gaps in the sequence.
+        int frameIndex = numFramesSubmitted_;
+
+        auto task = [this, frameIndex, pixels = std::move(pixels)]() {
+            // Frames that failed to write are not counted.
+            if (WriteFrame(pixels, frameIndex)) {
+                ++numFramesWritten_;
+            }
+        };
+
+        if (policy_ == OverflowPolicy::Block) {
+            writer_->Submit(std::move(task));
+        }
+        else if (!writer_->TrySubmit(std::move(task))) {
+            ++numFramesDropped_;
+            return;
+        }
+
+        ++numFramesSubmitted_;
+    }
+
+    bool FrameRecorder::WriteFrame(const std::vector<unsigned char>& pixels, int frameIndex) {
+        if (format_ == Format::PNGSequence) {
+            char filename[32];
+            std::snprintf(filename, sizeof(filename), "frame_%06d.png", frameIndex);
+
+            std::string filepath = (std::filesystem::path(filepath_) / filename).string();
+            if (!stbi_write_png(filepath.c_str(), width_, height_, 4, pixels.data(), 0)) {
+                std::cerr << "Failed to write recorded frame: " << filepath << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        // Once the video stream has failed (full disk, I/O error), no later frame can be written either. Only the first
+        // failure is reported.
+        if (!video_.good()) {
+            return false;
+        }
+
+        // Convert to full resolution (4:4:4) planar YUV, BT.601 limited range.
+        std::size_t planeSize = static_cast<std::size_t>(width_) * height_;
+        unsigned char* yPlane = planes_.data();
+        unsigned char* uPlane = yPlane + planeSize;
+        unsigned char* vPlane = uPlane + planeSize;
+
+        for (int y = 0; y < height_; ++y) {
+            // Rows are read back from OpenGL bottom row first.
+            const unsigned char* source = pixels.data() + static_cast<std::size_t>(height_ - 1 - y) * width_ * 4;
+            std::size_t row = static_cast<std::size_t>(y) * width_;
+
+            for (int x = 0; x < width_; ++x) {
+                float r = source[x * 4 + 0];
+                float g = source[x * 4 + 1];
+                float b = source[x * 4 + 2];
+
+                yPlane[row + x] = static_cast<unsigned char>(16.0f + 0.256788f * r + 0.504129f * g + 0.097906f * b + 0.5f);
+                uPlane[row + x] = static_cast<unsigned char>(128.0f - 0.148223f * r - 0.290993f * g + 0.439216f * b + 0.5f);
+                vPlane[row + x] = static_cast<unsigned char>(128.0f + 0.439216f * r - 0.367788f * g - 0.071427f * b + 0.5f);
+            }
+        }
+
+        video_ << "FRAME\n";
+        video_.write(reinterpret_cast<const char*>(planes_.data()), static_cast<std::streamsize>(planes_.size()));
+
+        if (!video_.good()) {
+            std::cerr << "Failed to write recorded frame " << frameIndex << ": " << filepath_ << ".y4m" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,106 @@
+
+#include "gpu_timer.h"
+
+namespace OpenGL {
+
+    GPUTimer::GPUTimer(unsigned numQueries) : queries_(std::max(numQueries, 1u)),
+                                              next_(0),
+                                              isTiming_(false),
+                                              elapsed_(0.0f),
+                                              average_(0.0f),
+                                              numMeasurements_(0) {
+        for (Query& query : queries_) {
+            glGenQueries(1, &query.start);
+            glGenQueries(1, &query.end);
+            query.discard = false;
+        }
+    }
+
+    GPUTimer::~GPUTimer() {
+        for (Query& query : queries_) {
+            glDeleteQueries(1, &query.start);
+            glDeleteQueries(1, &query.end);
+        }
+    }
+
+    void GPUTimer::Begin() {
+        if (inFlight_.size() == queries_.size()) {
+            // Results are not coming back fast enough, skip this measurement.
+            isTiming_ = false;
+            return;
+        }
+
+        Query& query = queries_[next_];
+        query.discard = false;
+        glQueryCounter(query.start, GL_TIMESTAMP);
+        isTiming_ = true;
+    }
+
+    void GPUTimer::End() {
+        if (!isTiming_) {
+            return;
+        }
+
+        glQueryCounter(queries_[next_].end, GL_TIMESTAMP);
+        inFlight_.push(next_);
+
+        next_ = (next_ + 1) % queries_.size();
+        isTiming_ = false;
+    }
+
+    bool GPUTimer::Update() {
+        bool updated = false;
+
+        while (!inFlight_.empty()) {
+            Query& query = queries_[inFlight_.front()];
+
+            // Queries complete in order, the end timestamp being available implies the start timestamp is too.
+            GLint available = 0;
+            glGetQueryObjectiv(query.end, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                break;
+            }
+
+            inFlight_.pop();
+
+            if (query.discard) {
+                continue;
+            }
+
+            GLuint64 start;
+            GLuint64 end;
+            glGetQueryObjectui64v(query.start, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+
+            elapsed_ = static_cast<float>(static_cast<double>(end - start) / 1000000.0);
+            average_ = numMeasurements_ > 0 ? (average_ + (elapsed_ - average_) * 0.1f) : elapsed_;
+            ++numMeasurements_;
+            updated = true;
+        }
+
+        return updated;
+    }
+
+    void GPUTimer::Reset() {
+        std::queue<unsigned> inFlight = inFlight_;
+        while (!inFlight.empty()) {
+            queries_[inFlight.front()].discard = true;
+            inFlight.pop();
+        }
+
+        numMeasurements_ = 0;
+    }
+
+    float GPUTimer::GetElapsedMilliseconds() const {
+        return elapsed_;
+    }
+
+    float GPUTimer::GetAverageMilliseconds() const {
+        return average_;
+    }
+
+    int GPUTimer::GetNumMeasurements() const {
+        return numMeasurements_;
+    }
+
+}
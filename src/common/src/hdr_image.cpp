@@ -0,0 +1,270 @@
+
+#include "hdr_image.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        // Float -> half precision conversion (round to nearest even).
+        // https://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/
+        std::uint16_t FloatToHalf(float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(float));
+
+            std::uint32_t sign = (bits >> 16u) & 0x8000u;
+            bits &= 0x7fffffffu;
+
+            // Result is infinity or NaN (all exponent bits set).
+            if (bits >= 0x47800000u) {
+                return static_cast<std::uint16_t>(sign | (bits > 0x7f800000u ? 0x7e00u : 0x7c00u));
+            }
+
+            // Result is denormalized or zero.
+            if (bits < 0x38800000u) {
+                float magnitude;
+                std::memcpy(&magnitude, &bits, sizeof(float));
+                magnitude += 0.5f; // Shift mantissa into the denormalized range, FPU handles rounding.
+
+                std::uint32_t denormalized;
+                std::memcpy(&denormalized, &magnitude, sizeof(float));
+                return static_cast<std::uint16_t>(sign | (denormalized - 0x3f000000u));
+            }
+
+            std::uint32_t mantissaOdd = (bits >> 13u) & 1u;
+            bits += 0xc8000fffu + mantissaOdd; // Rebias exponent, round mantissa.
+            return static_cast<std::uint16_t>(sign | (bits >> 13u));
+        }
+
+        template <typename T>
+        void WriteBinary(std::ofstream& stream, T value) {
+            // OpenEXR / PFM data is little endian, as are all the platforms the samples run on.
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void WriteAttribute(std::ofstream& stream, const std::string& name, const std::string& type, int size) {
+            stream.write(name.c_str(), static_cast<std::streamsize>(name.size() + 1));
+            stream.write(type.c_str(), static_cast<std::streamsize>(type.size() + 1));
+            WriteBinary<std::int32_t>(stream, size);
+        }
+
+        // https://openexr.com/en/latest/OpenEXRFileLayout.html
+        bool WriteOpenEXR(const std::string& filename, bool halfPrecision, int width, int height, const std::vector<HDRLayer>& layers) {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            struct Channel {
+                std::string name;
+                const HDRLayer* layer;
+                int component;
+            };
+
+            // Channels must be stored in alphabetical order.
+            std::vector<Channel> channels;
+            for (const HDRLayer& layer : layers) {
+                std::string prefix = layer.name.empty() ? "" : layer.name + ".";
+                channels.push_back({ prefix + "R", &layer, 0 });
+                channels.push_back({ prefix + "G", &layer, 1 });
+                channels.push_back({ prefix + "B", &layer, 2 });
+            }
+            std::sort(channels.begin(), channels.end(), [](const Channel& a, const Channel& b) {
+                return a.name < b.name;
+            });
+
+            int pixelType = halfPrecision ? 1 : 2; // HALF, FLOAT
+            std::size_t componentSize = halfPrecision ? sizeof(std::uint16_t) : sizeof(float);
+
+            // Magic number, version 2 (single-part scanline file).
+            WriteBinary<std::int32_t>(stream, 20000630);
+            WriteBinary<std::int32_t>(stream, 2);
+
+            // Header.
+            int channelListSize = 1;
+            for (const Channel& channel : channels) {
+                channelListSize += static_cast<int>(channel.name.size()) + 1 + 16;
+            }
+
+            WriteAttribute(stream, "channels", "chlist", channelListSize);
+            for (const Channel& channel : channels) {
+                stream.write(channel.name.c_str(), static_cast<std::streamsize>(channel.name.size() + 1));
+                WriteBinary<std::int32_t>(stream, pixelType);
+                WriteBinary<std::uint32_t>(stream, 0); // pLinear + reserved.
+                WriteBinary<std::int32_t>(stream, 1); // x sampling.
+                WriteBinary<std::int32_t>(stream, 1); // y sampling.
+            }
+            WriteBinary<std::uint8_t>(stream, 0);
+
+            WriteAttribute(stream, "compression", "compression", 1);
+            WriteBinary<std::uint8_t>(stream, 0); // NO_COMPRESSION.
+
+            for (const char* window : { "dataWindow", "displayWindow" }) {
+                WriteAttribute(stream, window, "box2i", 16);
+                WriteBinary<std::int32_t>(stream, 0);
+                WriteBinary<std::int32_t>(stream, 0);
+                WriteBinary<std::int32_t>(stream, width - 1);
+                WriteBinary<std::int32_t>(stream, height - 1);
+            }
+
+            WriteAttribute(stream, "lineOrder", "lineOrder", 1);
+            WriteBinary<std::uint8_t>(stream, 0); // INCREASING_Y.
+
+            WriteAttribute(stream, "pixelAspectRatio", "float", 4);
+            WriteBinary<float>(stream, 1.0f);
+
+            WriteAttribute(stream, "screenWindowCenter", "v2f", 8);
+            WriteBinary<float>(stream, 0.0f);
+            WriteBinary<float>(stream, 0.0f);
+
+            WriteAttribute(stream, "screenWindowWidth", "float", 4);
+            WriteBinary<float>(stream, 1.0f);
+
+            WriteBinary<std::uint8_t>(stream, 0); // End of header.
+
+            // Uncompressed scanlines all have the same size, so the line offset table can be written up front.
+            std::size_t scanlineDataSize = static_cast<std::size_t>(width) * channels.size() * componentSize;
+            std::size_t scanlineBlockSize = sizeof(std::int32_t) * 2 + scanlineDataSize;
+            std::uint64_t offset = static_cast<std::uint64_t>(stream.tellp()) + static_cast<std::uint64_t>(height) * sizeof(std::uint64_t);
+
+            for (int y = 0; y < height; ++y) {
+                WriteBinary<std::uint64_t>(stream, offset);
+                offset += scanlineBlockSize;
+            }
+
+            // Scanlines, top to bottom. Each scanline stores all values for one channel before moving on to the next.
+            std::vector<char> scanline(scanlineDataSize);
+
+            for (int y = 0; y < height; ++y) {
+                int row = height - 1 - y; // Source data is bottom to top.
+                char* destination = scanline.data();
+
+                for (const Channel& channel : channels) {
+                    const HDRLayer& layer = *channel.layer;
+                    const float* source = layer.data + static_cast<std::size_t>(row) * width * layer.numComponents + channel.component;
+
+                    for (int x = 0; x < width; ++x) {
+                        float value = source[static_cast<std::size_t>(x) * layer.numComponents];
+
+                        if (halfPrecision) {
+                            std::uint16_t half = FloatToHalf(value);
+                            std::memcpy(destination, &half, sizeof(std::uint16_t));
+                        }
+                        else {
+                            std::memcpy(destination, &value, sizeof(float));
+                        }
+
+                        destination += componentSize;
+                    }
+                }
+
+                WriteBinary<std::int32_t>(stream, y);
+                WriteBinary<std::int32_t>(stream, static_cast<std::int32_t>(scanlineDataSize));
+                stream.write(scanline.data(), static_cast<std::streamsize>(scanlineDataSize));
+            }
+
+            return stream.good();
+        }
+
+        // http://www.pauldebevec.com/Research/HDR/PFM/
+        bool WritePFM(const std::string& filename, int width, int height, const HDRLayer& layer) {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            // Negative scale denotes little endian data.
+            stream << "PF\n" << width << " " << height << "\n-1.0\n";
+
+            // PFM scanlines are stored bottom to top, same as the source data.
+            std::vector<float> scanline(static_cast<std::size_t>(width) * 3);
+
+            for (int y = 0; y < height; ++y) {
+                const float* source = layer.data + static_cast<std::size_t>(y) * width * layer.numComponents;
+
+                for (int x = 0; x < width; ++x) {
+                    for (int component = 0; component < 3; ++component) {
+                        scanline[static_cast<std::size_t>(x) * 3 + component] = source[static_cast<std::size_t>(x) * layer.numComponents + component];
+                    }
+                }
+
+                stream.write(reinterpret_cast<const char*>(scanline.data()), static_cast<std::streamsize>(scanline.size() * sizeof(float)));
+            }
+
+            return stream.good();
+        }
+
+        bool WriteRadiance(const std::string& filename, int width, int height, const HDRLayer& layer) {
+            // stb_image_write encodes one scanline at a time directly from the source data (ignoring alpha), flipping
+            // is handled by indexing rows in reverse.
+            stbi_flip_vertically_on_write(true);
+            return stbi_write_hdr(filename.c_str(), width, height, layer.numComponents, layer.data) != 0;
+        }
+
+    }
+
+    const char* GetHDRFormatExtension(HDRFormat format) {
+        switch (format) {
+            case HDRFormat::OpenEXRHalf:
+            case HDRFormat::OpenEXRFloat:
+                return "exr";
+            case HDRFormat::PFM:
+                return "pfm";
+            case HDRFormat::Radiance:
+                return "hdr";
+            default:
+                return "";
+        }
+    }
+
+    bool WriteHDRImage(const std::string& filepath, HDRFormat format, int width, int height, const std::vector<HDRLayer>& layers) {
+        if (layers.empty() || width <= 0 || height <= 0) {
+            return false;
+        }
+
+        for (const HDRLayer& layer : layers) {
+            if (!layer.data || layer.numComponents < 3) {
+                return false;
+            }
+        }
+
+        std::string filename = filepath + "." + GetHDRFormatExtension(format);
+
+        switch (format) {
+            case HDRFormat::OpenEXRHalf:
+                return WriteOpenEXR(filename, true, width, height, layers);
+            case HDRFormat::OpenEXRFloat:
+                return WriteOpenEXR(filename, false, width, height, layers);
+            case HDRFormat::PFM:
+                return WritePFM(filename, width, height, layers.front());
+            case HDRFormat::Radiance:
+                return WriteRadiance(filename, width, height, layers.front());
+            default:
+                return false;
+        }
+    }
+
+    bool ReadPFMImage(const std::string& filepath, int& width, int& height, std::vector<float>& data) {
+        std::ifstream stream(filepath, std::ios::binary);
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        // Grayscale ('Pf') and big endian (positive scale) images are not supported.
+        std::string type;
+        float scale;
+        stream >> type >> width >> height >> scale;
+
+        if (!stream || type != "PF" || width <= 0 || height <= 0 || scale >= 0.0f) {
+            return false;
+        }
+
+        // Exactly one whitespace character separates the header from the data.
+        stream.get();
+
+        data.resize(static_cast<std::size_t>(width) * height * 3);
+        stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(float)));
+
+        return stream.good();
+    }
+
+}
@@ -0,0 +1,83 @@
+
+#include "image_capture.h"
+
+namespace OpenGL {
+
+    ImageCapture::ImageCapture() : readback_(3),
+                                   numPendingCaptures_(0),
+                                   writer_(1) {
+        // Images are read back from OpenGL bottom row first.
+        // Note: the flag is global to stb_image_write, every writer in the samples (FrameRecorder, WriteRadiance) sets it
+        // to true as well.
+        stbi_flip_vertically_on_write(true);
+    }
+
+    ImageCapture::~ImageCapture() {
+    }
+
+    bool ImageCapture::Capture(GLuint texture, int width, int height, const std::string& filepath) {
+        int channels = 4;
+        std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * channels;
+
+        return readback_.ReadTexture(texture, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, size, [this, width, height, channels, filepath](std::vector<unsigned char> pixels) {
+            ++numPendingCaptures_;
+
+            // Encoding a 4K image takes hundreds of milliseconds, keep it off the render thread.
+            writer_.Submit([this, width, height, channels, filepath, pixels = std::move(pixels)]() {
+                std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+                if (!directory.empty() && !std::filesystem::exists(directory)) {
+                    // Create output directory if it doesn't exist.
+                    std::filesystem::create_directories(directory);
+                }
+
+                if (!stbi_write_png((filepath + ".png").c_str(), width, height, channels, pixels.data(), 0)) {
+                    std::cerr << "Failed to write screenshot: " << filepath << ".png" << std::endl;
+                }
+                if (!stbi_write_jpg((filepath + ".jpg").c_str(), width, height, channels, pixels.data(), 100)) {
+                    std::cerr << "Failed to write screenshot: " << filepath << ".jpg" << std::endl;
+                }
+
+                --numPendingCaptures_;
+            });
+        });
+    }
+
+    bool ImageCapture::CaptureHDR(GLuint texture, int width, int height, const std::string& filepath, HDRFormat format) {
+        int channels = 4;
+        std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * channels * sizeof(float);
+
+        return readback_.ReadTexture(texture, 0, width, height, GL_RGBA, GL_FLOAT, size, [this, width, height, channels, filepath, format](std::vector<unsigned char> pixels) {
+            ++numPendingCaptures_;
+
+            writer_.Submit([this, width, height, channels, filepath, format, pixels = std::move(pixels)]() {
+                std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+                if (!directory.empty() && !std::filesystem::exists(directory)) {
+                    // Create output directory if it doesn't exist.
+                    std::filesystem::create_directories(directory);
+                }
+
+                // The readback copy is the only full-size copy of the image, the writer converts one scanline at a time.
+                HDRLayer layer { "", reinterpret_cast<const float*>(pixels.data()), channels };
+                if (!WriteHDRImage(filepath, format, width, height, { layer })) {
+                    std::cerr << "Failed to write HDR image: " << filepath << "." << GetHDRFormatExtension(format) << std::endl;
+                }
+
+                --numPendingCaptures_;
+            });
+        });
+    }
+
+    void ImageCapture::Update() {
+        readback_.Update();
+    }
+
+    void ImageCapture::Flush() {
+        readback_.Flush();
+        writer_.Wait();
+    }
+
+    int ImageCapture::GetNumPendingCaptures() const {
+        return static_cast<int>(readback_.GetNumRequestsInFlight()) + numPendingCaptures_;
+    }
+
+}
@@ -148,6 +148,10 @@ namespace OpenGL {
         return mesh;
     }
 
+    void ObjectLoader::ClearCache() {
+        loadedMeshes_.clear();
+    }
+
     ObjectLoader::ObjectLoader() {
 
     }
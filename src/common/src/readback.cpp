@@ -0,0 +1,143 @@
+
+#include "readback.h"
+
+namespace OpenGL {
+
+    AsyncReadback::AsyncReadback(unsigned numBuffers) : requests_(std::max(numBuffers, 1u)),
+                                                        next_(0) {
+        for (Request& request : requests_) {
+            glGenBuffers(1, &request.buffer);
+            request.capacity = 0;
+            request.size = 0;
+            request.fence = nullptr;
+        }
+    }
+
+    AsyncReadback::~AsyncReadback() {
+        for (Request& request : requests_) {
+            if (request.fence) {
+                glDeleteSync(request.fence);
+            }
+            glDeleteBuffers(1, &request.buffer);
+        }
+    }
+
+    bool AsyncReadback::ReadTexture(GLuint texture, GLint level, int width, int height, GLenum format, GLenum type, std::size_t size, Callback onComplete) {
+        Request* request = Acquire(size);
+        if (!request) {
+            return false;
+        }
+
+        // With a pixel pack buffer bound, the data pointer is interpreted as an offset into the buffer and the call
+        // returns without waiting for the GPU.
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, request->buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGetTexImage(GL_TEXTURE_2D, level, format, type, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        request->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        request->onComplete = std::move(onComplete);
+        return true;
+    }
+
+    bool AsyncReadback::ReadBuffer(GLuint buffer, std::size_t offset, std::size_t size, Callback onComplete) {
+        Request* request = Acquire(size);
+        if (!request) {
+            return false;
+        }
+
+        // Buffer to buffer copies are queued like any other command.
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, request->buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), 0, static_cast<GLsizeiptr>(size));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        request->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        request->onComplete = std::move(onComplete);
+        return true;
+    }
+
+    void AsyncReadback::Update() {
+        while (!inFlight_.empty()) {
+            Request& request = requests_[inFlight_.front()];
+
+            // Transfers complete in submission order, the first one that is not yet done means none of the later ones are.
+            GLenum status = glClientWaitSync(request.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+
+            inFlight_.pop();
+            Complete(request);
+        }
+    }
+
+    void AsyncReadback::Flush() {
+        while (!inFlight_.empty()) {
+            Request& request = requests_[inFlight_.front()];
+            glClientWaitSync(request.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+
+            inFlight_.pop();
+            Complete(request);
+        }
+    }
+
+    bool AsyncReadback::IsBusy() const {
+        return inFlight_.size() == requests_.size();
+    }
+
+    unsigned AsyncReadback::GetNumRequestsInFlight() const {
+        return static_cast<unsigned>(inFlight_.size());
+    }
+
+    AsyncReadback::Request* AsyncReadback::Acquire(std::size_t size) {
+        if (IsBusy()) {
+            return nullptr;
+        }
+
+        unsigned index = next_;
+        next_ = (next_ + 1) % requests_.size();
+
+        Request& request = requests_[index];
+        if (request.capacity < size) {
+            // Buffer storage only grows, captures of the same size reuse the existing allocation.
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, request.buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            request.capacity = size;
+        }
+
+        request.size = size;
+        inFlight_.push(index);
+        return &request;
+    }
+
+    void AsyncReadback::Complete(Request& request) {
+        std::vector<unsigned char> data(request.size);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, request.buffer);
+        void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(request.size), GL_MAP_READ_BIT);
+        if (mapped) {
+            std::memcpy(data.data(), mapped, request.size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        glDeleteSync(request.fence);
+        request.fence = nullptr;
+
+        Callback onComplete = std::move(request.onComplete);
+        request.onComplete = nullptr;
+
+        if (mapped && onComplete) {
+            onComplete(std::move(data));
+        }
+    }
+
+}
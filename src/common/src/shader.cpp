@@ -9,14 +9,12 @@ namespace OpenGL {
     }
 
     Shader::Shader(std::string name, std::initializer_list<std::string> shaderComponents) : name_(std::move(name)) {
-        std::vector<ShaderComponent> components;
-
-        for (const std::string& component : shaderComponents) {
-            GLenum shaderType = ShaderTypeFromExtension(Utilities::GetAssetExtension(component));
-            components.emplace_back(ShaderComponent(component, shaderType));
-        }
+        CreateShader(ComponentsFromExtensions(shaderComponents));
+    }
 
-        CreateShader(components);
+    Shader::Shader(std::string name, std::initializer_list<std::string> shaderComponents, std::vector<ShaderDefine> defines) : name_(std::move(name)),
+                                                                                                                               defines_(std::move(defines)) {
+        CreateShader(ComponentsFromExtensions(shaderComponents));
     }
 
     Shader::~Shader() {
@@ -31,6 +29,23 @@ namespace OpenGL {
         glUseProgram(0);
     }
 
+    glm::ivec3 Shader::GetWorkGroupSize() const {
+        glm::ivec3 workGroupSize(0);
+        glGetProgramiv(program_, GL_COMPUTE_WORK_GROUP_SIZE, glm::value_ptr(workGroupSize));
+        return workGroupSize;
+    }
+
+    std::vector<Shader::ShaderComponent> Shader::ComponentsFromExtensions(std::initializer_list<std::string> shaderComponents) const {
+        std::vector<ShaderComponent> components;
+
+        for (const std::string& component : shaderComponents) {
+            GLenum shaderType = ShaderTypeFromExtension(Utilities::GetAssetExtension(component));
+            components.emplace_back(ShaderComponent(component, shaderType));
+        }
+
+        return components;
+    }
+
     std::string Shader::ShaderTypeToString(GLenum shaderType) const {
         switch(shaderType) {
             case GL_FRAGMENT_SHADER:
@@ -39,6 +54,8 @@ namespace OpenGL {
                 return "VERTEX";
             case GL_GEOMETRY_SHADER:
                 return "GEOMETRY";
+            case GL_COMPUTE_SHADER:
+                return "COMPUTE";
             default:
                 return "";
         }
@@ -49,7 +66,7 @@ namespace OpenGL {
         GLenum shaderType = shaderComponent.second;
 
         // Read in shader source.
-        std::string fileContents = ReadShaderFile(shaderFilePath);
+        std::string fileContents = InjectDefines(ReadShaderFile(shaderFilePath));
         const GLchar* shaderSource = reinterpret_cast<const GLchar*>(fileContents.c_str());
 
         // Create shader from source.
@@ -98,6 +115,31 @@ namespace OpenGL {
         return std::move(fileContents);
     }
 
+    std::string Shader::InjectDefines(const std::string& source) const {
+        if (defines_.empty()) {
+            return source;
+        }
+
+        std::string defines;
+        for (const ShaderDefine& define : defines_) {
+            defines += "#define " + define.first + " " + define.second + "\n";
+        }
+
+        // The #version directive must come before anything else in the shader source.
+        std::size_t version = source.find("#version");
+        if (version == std::string::npos) {
+            return defines + source;
+        }
+
+        std::size_t lineEnd = source.find('\n', version);
+        if (lineEnd == std::string::npos) {
+            return source + "\n" + defines;
+        }
+
+        // Note: line numbers in compilation errors are offset by the number of injected definitions.
+        return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+    }
+
     GLenum Shader::ShaderTypeFromExtension(const std::string &extension) const {
         if (extension == "vert") {
             return GL_VERTEX_SHADER;
@@ -108,6 +150,9 @@ namespace OpenGL {
         if (extension == "geom") {
             return GL_GEOMETRY_SHADER;
         }
+        if (extension == "comp") {
+            return GL_COMPUTE_SHADER;
+        }
 
         return GL_INVALID_VALUE;
     }
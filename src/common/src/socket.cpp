@@ -0,0 +1,235 @@
+
+#include "socket.h"
+
+#include <climits>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+namespace OpenGL {
+
+    namespace {
+
+        const Socket::Handle invalidHandle = static_cast<Socket::Handle>(-1);
+
+#ifdef _WIN32
+        // Winsock needs to be initialized once per process before any socket is created.
+        void InitializeSockets() {
+            static bool initialized = []() -> bool {
+                WSADATA data;
+                return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+
+            if (!initialized) {
+                std::cerr << "Failed to initialize Winsock." << std::endl;
+            }
+        }
+
+        void CloseSocket(Socket::Handle handle) {
+            closesocket(static_cast<SOCKET>(handle));
+        }
+#else
+        void InitializeSockets() {
+        }
+
+        void CloseSocket(Socket::Handle handle) {
+            close(handle);
+        }
+#endif
+
+        Socket::Handle CreateHandle() {
+            InitializeSockets();
+            return static_cast<Socket::Handle>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        }
+
+        sockaddr_in LoopbackAddress(int port) {
+            sockaddr_in address { };
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<std::uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            return address;
+        }
+
+        // Messages are small and latency sensitive, do not wait to coalesce them.
+        void DisableNagle(Socket::Handle handle) {
+            int enable = 1;
+            setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+        }
+
+    }
+
+    Socket::Socket() : handle_(invalidHandle) {
+    }
+
+    Socket::Socket(Handle handle) : handle_(handle) {
+    }
+
+    Socket::~Socket() {
+        Close();
+    }
+
+    Socket::Socket(Socket&& other) noexcept : handle_(other.handle_) {
+        other.handle_ = invalidHandle;
+    }
+
+    Socket& Socket::operator=(Socket&& other) noexcept {
+        if (this != &other) {
+            Close();
+            handle_ = other.handle_;
+            other.handle_ = invalidHandle;
+        }
+
+        return *this;
+    }
+
+    Socket Socket::Listen(int port) {
+        Socket listener(CreateHandle());
+        if (!listener.IsValid()) {
+            return { };
+        }
+
+        // Allow restarting immediately on the same port, while connections of a previous run are still being torn down.
+        int enable = 1;
+        setsockopt(listener.handle_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enable), sizeof(enable));
+
+        sockaddr_in address = LoopbackAddress(port);
+        if (bind(listener.handle_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            return { };
+        }
+
+        if (listen(listener.handle_, SOMAXCONN) != 0) {
+            return { };
+        }
+
+        return listener;
+    }
+
+    Socket Socket::Connect(int port) {
+        Socket connection(CreateHandle());
+        if (!connection.IsValid()) {
+            return { };
+        }
+
+        sockaddr_in address = LoopbackAddress(port);
+        if (connect(connection.handle_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            return { };
+        }
+
+        DisableNagle(connection.handle_);
+        return connection;
+    }
+
+    std::vector<bool> Socket::Poll(const std::vector<const Socket*>& sockets, int timeout) {
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> descriptors(sockets.size());
+#else
+        std::vector<pollfd> descriptors(sockets.size());
+#endif
+
+        for (std::size_t i = 0; i < sockets.size(); ++i) {
+            descriptors[i].fd = static_cast<decltype(descriptors[i].fd)>(sockets[i]->handle_);
+            descriptors[i].events = POLLIN;
+            descriptors[i].revents = 0;
+        }
+
+#ifdef _WIN32
+        int result = WSAPoll(descriptors.data(), static_cast<ULONG>(descriptors.size()), timeout);
+#else
+        int result = poll(descriptors.data(), static_cast<nfds_t>(descriptors.size()), timeout);
+#endif
+
+        std::vector<bool> ready(sockets.size(), false);
+        if (result <= 0) {
+            // Timed out (or interrupted).
+            return ready;
+        }
+
+        for (std::size_t i = 0; i < sockets.size(); ++i) {
+            ready[i] = (descriptors[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL)) != 0;
+        }
+
+        return ready;
+    }
+
+    Socket Socket::Accept() const {
+        Handle handle = static_cast<Handle>(accept(handle_, nullptr, nullptr));
+        if (handle == invalidHandle) {
+            return { };
+        }
+
+        DisableNagle(handle);
+        return Socket(handle);
+    }
+
+    bool Socket::Send(const void* data, std::size_t size) const {
+        const char* bytes = static_cast<const char*>(data);
+
+        // Writing to a connection closed by the peer should fail instead of raising SIGPIPE.
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+
+        while (size > 0) {
+            auto sent = send(handle_, bytes, static_cast<int>(std::min<std::size_t>(size, INT_MAX)), flags);
+            if (sent <= 0) {
+                return false;
+            }
+
+            bytes += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+
+        return true;
+    }
+
+    bool Socket::Receive(void* data, std::size_t size) const {
+        char* bytes = static_cast<char*>(data);
+
+        while (size > 0) {
+            auto received = recv(handle_, bytes, static_cast<int>(std::min<std::size_t>(size, INT_MAX)), 0);
+            if (received <= 0) {
+                // Zero bytes is an orderly shutdown by the peer.
+                return false;
+            }
+
+            bytes += received;
+            size -= static_cast<std::size_t>(received);
+        }
+
+        return true;
+    }
+
+    void Socket::Close() {
+        if (handle_ != invalidHandle) {
+            CloseSocket(handle_);
+            handle_ = invalidHandle;
+        }
+    }
+
+    bool Socket::IsValid() const {
+        return handle_ != invalidHandle;
+    }
+
+    int Socket::GetPort() const {
+        sockaddr_in address { };
+        socklen_t length = sizeof(address);
+
+        if (getsockname(handle_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            return 0;
+        }
+
+        return ntohs(address.sin_port);
+    }
+
+}
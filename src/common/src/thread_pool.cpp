@@ -0,0 +1,102 @@
+
+#include "thread_pool.h"
+
+namespace OpenGL {
+
+    ThreadPool::ThreadPool(unsigned numThreads, std::size_t capacity) : capacity_(capacity),
+                                                                        numActiveTasks_(0),
+                                                                        isRunning_(true) {
+        // std::thread::hardware_concurrency is allowed to return 0 if the value is not computable.
+        numThreads = std::max(numThreads, 1u);
+
+        for (unsigned i = 0; i < numThreads; ++i) {
+            threads_.emplace_back(&ThreadPool::Run, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            isRunning_ = false;
+        }
+        taskAvailable_.notify_all();
+
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::Submit(Task task) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            spaceAvailable_.wait(lock, [this]() {
+                return capacity_ == 0 || tasks_.size() < capacity_;
+            });
+
+            tasks_.push(std::move(task));
+        }
+        taskAvailable_.notify_one();
+    }
+
+    bool ThreadPool::TrySubmit(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (capacity_ != 0 && tasks_.size() >= capacity_) {
+                return false;
+            }
+
+            tasks_.push(std::move(task));
+        }
+        taskAvailable_.notify_one();
+
+        return true;
+    }
+
+    void ThreadPool::Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasksFinished_.wait(lock, [this]() {
+            return tasks_.empty() && numActiveTasks_ == 0;
+        });
+    }
+
+    std::size_t ThreadPool::GetNumPendingTasks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.size() + numActiveTasks_;
+    }
+
+    unsigned ThreadPool::GetNumThreads() const {
+        return static_cast<unsigned>(threads_.size());
+    }
+
+    void ThreadPool::Run() {
+        while (true) {
+            Task task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                taskAvailable_.wait(lock, [this]() {
+                    return !isRunning_ || !tasks_.empty();
+                });
+
+                // Remaining tasks are still executed during shutdown.
+                if (tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop();
+                ++numActiveTasks_;
+            }
+            spaceAvailable_.notify_one();
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --numActiveTasks_;
+            }
+            tasksFinished_.notify_all();
+        }
+    }
+
+}
@@ -83,4 +83,33 @@ namespace Utilities {
         throw std::runtime_error("Provided directory does not exist.");
     }
 
-}
\ No newline at end of file
+    namespace {
+
+        unsigned SpreadBits2D(unsigned value) {
+            // Insert a zero bit between each of the lower 16 bits.
+            value &= 0x0000ffffu;
+            value = (value | (value << 8u)) & 0x00ff00ffu;
+            value = (value | (value << 4u)) & 0x0f0f0f0fu;
+            value = (value | (value << 2u)) & 0x33333333u;
+            value = (value | (value << 1u)) & 0x55555555u;
+            return value;
+        }
+
+    }
+
+    unsigned EncodeMorton2D(unsigned x, unsigned y) {
+        return SpreadBits2D(x) | (SpreadBits2D(y) << 1u);
+    }
+
+    std::uint64_t HashFNV1a(const void* data, std::size_t size, std::uint64_t hash) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull; // FNV prime.
+        }
+
+        return hash;
+    }
+
+}
@@ -1,44 +1,89 @@
 #version 450 core
 
-#define EPSILON 0.001
-const float DRAG = -0.2;
+// Memory layout of the particles, see ParticleLayout in particle.h.
+#define LAYOUT_STD140 0
+#define LAYOUT_STD430 1
+#define LAYOUT_SOA 2
+#define LAYOUT_SOA_HALF_VELOCITY 3
 
-struct Particle {
-    vec3 position;
-    vec3 velocity;
-};
+#ifndef PARTICLE_LAYOUT
+    #define PARTICLE_LAYOUT LAYOUT_STD140
+#endif
+
+// Particles are simulated by particle.comp, rendering only reads them.
+#if PARTICLE_LAYOUT == LAYOUT_STD140
+    struct Particle {
+        vec3 position;
+        vec3 velocity;
+    };
+
+    layout (std140, binding = 0) readonly buffer ParticleSSBO {
+        Particle particles[];
+    } ssbo;
+#elif PARTICLE_LAYOUT == LAYOUT_STD430
+    struct Particle {
+        float position[3];
+        float velocity[3];
+    };
 
-layout (std140, binding = 0) buffer ParticleSSBO {
-    Particle particles[];
-} ssbo;
+    layout (std430, binding = 0) readonly buffer ParticleSSBO {
+        Particle particles[];
+    } ssbo;
+#else
+    // Velocities are not needed for rendering, the values used for color are packed into w (see particle.comp).
+    layout (std430, binding = 0) readonly buffer PositionSSBO {
+        vec4 positions[];
+    } positionSSBO;
+#endif
+
+#ifdef FRUSTUM_CULLING
+    // Indices of the particles inside the view frustum (see particle_cull.comp), one vertex is drawn per visible particle.
+    layout (std430, binding = 2) readonly buffer VisibleSSBO {
+        uint indices[];
+    } visibleSSBO;
+#endif
 
-uniform float dt;
-uniform vec3 centerOfGravity;
-uniform float isActive;
-uniform float isRunning;
 uniform mat4 cameraTransform;
 
 layout (location = 0) out vec4 particleColor;
 
 void main() {
-    Particle particle = ssbo.particles[gl_VertexID];
+#ifdef FRUSTUM_CULLING
+    uint index = visibleSSBO.indices[gl_VertexID];
+#else
+    uint index = uint(gl_VertexID);
+#endif
 
-    vec3 toCenterOfGravity = centerOfGravity - particle.position;
-    float distance = max(length(toCenterOfGravity), EPSILON);
+    vec3 position;
+    float speedSquared;
+    float maxVelocity; // Largest velocity component.
 
-    vec3 acceleration = 300.0 * isActive * isRunning / distance * (toCenterOfGravity / distance);
-    particle.velocity *= mix(1.0, exp(DRAG * dt), isRunning);
+#if PARTICLE_LAYOUT == LAYOUT_STD140 || PARTICLE_LAYOUT == LAYOUT_STD430
+    #if PARTICLE_LAYOUT == LAYOUT_STD140
+        Particle particle = ssbo.particles[index];
+        position = particle.position;
+        vec3 velocity = particle.velocity;
+    #else
+        Particle particle = ssbo.particles[index];
+        position = vec3(particle.position[0], particle.position[1], particle.position[2]);
+        vec3 velocity = vec3(particle.velocity[0], particle.velocity[1], particle.velocity[2]);
+    #endif
 
-    // Euler integration.
-    particle.position += (dt * particle.velocity + 0.5 * acceleration * dt * dt) * isRunning;
-    particle.velocity += acceleration * dt;
+    speedSquared = dot(velocity, velocity);
+    maxVelocity = max(velocity.x, max(velocity.y, velocity.z));
+#else
+    vec4 data = positionSSBO.positions[index];
+    position = data.xyz;
 
-    ssbo.particles[gl_VertexID] = particle;
+    vec2 colorInputs = unpackHalf2x16(floatBitsToUint(data.w));
+    speedSquared = colorInputs.x;
+    maxVelocity = colorInputs.y;
+#endif
 
-    float r = 0.0045 * dot(particle.velocity, particle.velocity);
-    float g = clamp(0.08 * max(particle.velocity.x, max(particle.velocity.y, particle.velocity.z)), 0.2, 0.5);
+    float r = 0.0045 * speedSquared;
+    float g = clamp(0.08 * maxVelocity, 0.2, 0.5);
     float b = 0.7 - r;
 
     particleColor = vec4(r, g, b, 0.15);
-    gl_Position = cameraTransform * vec4(particle.position, 1.0f);
-}
\ No newline at end of file
+    gl_Position = cameraTransform * vec4(position, 1.0f);
+}
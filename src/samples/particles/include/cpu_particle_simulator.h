@@ -0,0 +1,69 @@
+
+#ifndef OPENGL_SAMPLES_CPU_PARTICLE_SIMULATOR_H
+#define OPENGL_SAMPLES_CPU_PARTICLE_SIMULATOR_H
+
+#include "pch.h"
+#include "particle.h"
+#include "thread_pool.h"
+
+namespace OpenGL {
+
+    // Vector instruction sets used by the CPU simulation kernels, from narrowest to widest.
+    enum class InstructionSet {
+        Scalar = 0,
+        AVX2 = 1,  // 8 particles per instruction (with FMA).
+        AVX512 = 2 // 16 particles per instruction.
+    };
+
+    // Particle simulation on the CPU, for machines without a GPU (or to compare against it).
+    // Implements the same attraction, drag and integration as particle.comp over structure of arrays float buffers. Every
+    // step is split into chunks of particles that are simulated in parallel on a thread pool.
+    class CPUParticleSimulator {
+        public:
+            // Particles are initialized at the origin, at rest. Throws std::bad_alloc if the particles do not fit in memory.
+            explicit CPUParticleSimulator(std::size_t numParticles, unsigned numThreads = std::thread::hardware_concurrency());
+            ~CPUParticleSimulator();
+
+            // Distributes the particles uniformly in a ball of the given radius (as main.cpp does), at rest.
+            void Randomize(float radius, unsigned seed);
+
+            // The number of particles must match.
+            void SetParticles(const std::vector<Particle>& particles);
+            [[nodiscard]] std::vector<Particle> GetParticles() const;
+
+            // Advances all particles by a single timestep, blocks until done.
+            void Step(float dt, const glm::vec3& centerOfGravity, float isActive);
+
+            // Clamped to the widest instruction set supported by the CPU.
+            void SetInstructionSet(InstructionSet instructionSet);
+            [[nodiscard]] InstructionSet GetInstructionSet() const;
+
+            [[nodiscard]] std::size_t GetNumParticles() const;
+            [[nodiscard]] unsigned GetNumThreads() const;
+
+            // Bytes read and written per particle by a simulation step.
+            [[nodiscard]] std::size_t GetBytesPerParticle() const;
+
+            // Widest instruction set the CPU (and the build) supports.
+            [[nodiscard]] static InstructionSet GetSupportedInstructionSet();
+            [[nodiscard]] static std::string GetName(InstructionSet instructionSet);
+
+        private:
+            // Calls 'function' with the [begin, end) range of every chunk, in parallel.
+            void ForEachChunk(const std::function<void(std::size_t, std::size_t)>& function);
+
+            std::size_t numParticles_;
+            std::size_t chunkSize_;
+            InstructionSet instructionSet_;
+
+            // Memory is left uninitialized on allocation, so that pages are first touched by the worker threads that
+            // simulate them.
+            std::unique_ptr<float[]> positions_[3];
+            std::unique_ptr<float[]> velocities_[3];
+
+            ThreadPool threadPool_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_CPU_PARTICLE_SIMULATOR_H
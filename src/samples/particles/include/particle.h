@@ -6,12 +6,21 @@
 
 namespace OpenGL {
 
+    // Particle state on the CPU, and in the std140 layout on the GPU.
     struct Particle  {
         // glm::vec4 instead of glm::vec3 for buffer alignment.
         glm::vec4 position;
         glm::vec4 velocity;
     };
 
+    // Memory layouts of the particles on the GPU, see PARTICLE_LAYOUT in particle.comp / particle.vert.
+    enum class ParticleLayout {
+        Std140 = 0,         // Array of structures, vec4 position and velocity (32 bytes, 8 of which are padding).
+        Std430 = 1,         // Array of structures, tightly packed vec3 position and velocity (24 bytes).
+        SoA = 2,            // Positions (with the speed used for color, 16 bytes) and velocities (12 bytes) in separate buffers.
+        SoAHalfVelocity = 3 // As SoA, with half precision velocities (8 bytes).
+    };
+
 }
 
 #endif //OPENGL_SAMPLES_PARTICLE_H
@@ -0,0 +1,48 @@
+#ifndef OPENGL_SAMPLES_PARTICLE_BUFFERS_H
+#define OPENGL_SAMPLES_PARTICLE_BUFFERS_H
+
+#include "pch.h"
+#include "particle.h"
+
+namespace OpenGL {
+
+    // Particle state on the GPU, in one of the supported memory layouts.
+    // Array of structures layouts use a single buffer (binding 0). Structure of arrays layouts store positions in binding 0
+    // and velocities in binding 1, so that rendering only fetches positions.
+    class ParticleBuffers {
+        public:
+            ParticleBuffers(ParticleLayout layout, const std::vector<Particle>& particles);
+            ~ParticleBuffers();
+
+            // Binds the buffer(s) to the shader storage buffer bindings used by particle.comp and particle.vert.
+            void Bind() const;
+
+            // Reads back the current particle state, for converting between layouts. Stalls until the GPU is idle.
+            [[nodiscard]] std::vector<Particle> Download() const;
+
+            [[nodiscard]] ParticleLayout GetLayout() const;
+            [[nodiscard]] int GetNumParticles() const;
+
+            // Size of all buffers, in bytes.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+            // Bytes read and written per particle by a simulation step.
+            [[nodiscard]] std::size_t GetSimulationBytesPerParticle() const;
+
+            // Bytes read per particle by the render pass.
+            [[nodiscard]] std::size_t GetRenderBytesPerParticle() const;
+
+        private:
+            [[nodiscard]] std::size_t GetPositionSize() const;
+            [[nodiscard]] std::size_t GetVelocitySize() const;
+
+            ParticleLayout layout_;
+            int numParticles_;
+
+            // Only the first buffer is used by array of structures layouts.
+            GLuint buffers_[2];
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_PARTICLE_BUFFERS_H
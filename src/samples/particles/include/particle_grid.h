@@ -0,0 +1,70 @@
+
+#ifndef OPENGL_SAMPLES_PARTICLE_GRID_H
+#define OPENGL_SAMPLES_PARTICLE_GRID_H
+
+#include "pch.h"
+#include "particle.h"
+#include "shader.h"
+#include "gpu_timer.h"
+#include "prefix_sum.h"
+
+namespace OpenGL {
+
+    // Uniform grid over the particles for neighbour queries, rebuilt on the GPU before every simulation step.
+    // Grid cells are hashed into a fixed number of buckets, and the particles are counting sorted by bucket into a copy
+    // that is independent of the particle layout. Force kernels find the neighbours of a particle in the buckets of the
+    // surrounding cells (see FindNeighborCells in particle_grid.comp), and write accelerations that particle.comp
+    // (compiled with NEIGHBOR_FORCES) applies.
+    //
+    // The stages are compiled from particle_grid.comp. Reads the particles from shader storage buffer bindings 0 and 1,
+    // and uses bindings 4 - 8 (and 17 - 19 for the prefix sum).
+    class ParticleGrid {
+        public:
+            // Throws std::runtime_error on compilation error.
+            ParticleGrid(ParticleLayout layout, int numParticles);
+            ~ParticleGrid();
+
+            // Sorts the particles into cells of the given size (at least the largest distance neighbours are searched
+            // in). Stages are only timed if 'measure' is set.
+            void Build(float cellSize, bool measure);
+
+            // Binds the grid, sorted particles and accelerations for force kernels (Build also binds them).
+            void Bind() const;
+
+            // Neighbour forces, compiled for the grid. Uniforms 'numParticles' and 'cellSize' need to be set to the values
+            // of the last build, and the kernel dispatched with a 256 invocation work group per 256 particles.
+            [[nodiscard]] Shader& GetFlockingShader();
+
+            // Polls the stage timers, once per frame.
+            void UpdateTimers();
+            void ResetTimers();
+
+            [[nodiscard]] float GetHistogramMilliseconds() const;
+            [[nodiscard]] float GetScanMilliseconds() const;
+            [[nodiscard]] float GetScatterMilliseconds() const;
+
+            // Cell tables, sorted particles and accelerations, in bytes.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+        private:
+            int numParticles_;
+
+            std::unique_ptr<Shader> histogramShader_;
+            PrefixSum prefixSum_;
+            std::unique_ptr<Shader> scatterShader_;
+            std::unique_ptr<Shader> flockingShader_;
+
+            GLuint cellStartBuffer_;
+            GLuint cellEndBuffer_;
+            GLuint particleBuffer_; // Sorted.
+            GLuint particleCellBuffer_;
+            GLuint accelerationBuffer_;
+
+            GPUTimer histogramTimer_;
+            GPUTimer scanTimer_;
+            GPUTimer scatterTimer_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_PARTICLE_GRID_H
@@ -0,0 +1,87 @@
+
+#ifndef OPENGL_SAMPLES_PARTICLE_OCTREE_H
+#define OPENGL_SAMPLES_PARTICLE_OCTREE_H
+
+#include "pch.h"
+#include "particle.h"
+#include "shader.h"
+#include "gpu_timer.h"
+#include "prefix_sum.h"
+
+namespace OpenGL {
+
+    // Octree over the particles for Barnes-Hut self-gravity, rebuilt on the GPU before every simulation step.
+    // The octree is complete up to a fixed depth and stored level by level in Morton order, so that it can be built with
+    // a counting sort of the particles by leaf followed by one reduction per level, and traversed without pointers. Every
+    // node stores the center of mass and mass of its particles. Nodes that are small compared to their distance are
+    // approximated by their center of mass, which brings the cost of the force evaluation from O(N^2) down to O(N log N).
+    // Gravitational accelerations are written for particle.comp (compiled with SELF_GRAVITY) to apply.
+    //
+    // The stages are compiled from particle_octree.comp. Reads the particles from shader storage buffer bindings 0 and 1,
+    // and uses bindings 10 - 16 (and 17 - 19 for the prefix sum).
+    class ParticleOctree {
+        public:
+            // Throws std::runtime_error on compilation error.
+            ParticleOctree(ParticleLayout layout, int numParticles);
+            ~ParticleOctree();
+
+            // Sorts the particles into the octree, and computes the mass and center of mass of every node.
+            // Only timed if 'measure' is set, the scan of the leaf counts is also timed separately.
+            void Build(bool measure);
+
+            // Binds the octree and accelerations (Build also binds them).
+            void Bind() const;
+
+            // Barnes-Hut approximation of the gravitational accelerations, requires a built octree. Nodes whose size is below
+            // 'openingAngle' times their distance are approximated, unless they contain the particle itself (0 sums over all
+            // pairs of particles). The gravitational
+            // constant is scaled by the mass of a particle, and 'softening' bounds the acceleration of close encounters.
+            // Only timed if 'measure' is set.
+            void ComputeGravity(float openingAngle, float gravitationalConstant, float softening, bool measure);
+
+            // Exact gravitational accelerations, summed over all pairs of particles (only feasible for small particle counts).
+            // Requires a built octree, as the particles are read in sorted order.
+            void ComputeGravityBruteForce(float gravitationalConstant, float softening);
+
+            // Accelerations of the last force evaluation, by particle index.
+            [[nodiscard]] std::vector<glm::vec4> DownloadAccelerations() const;
+
+            // Polls the timers, once per frame.
+            void UpdateTimers();
+            void ResetTimers();
+
+            [[nodiscard]] float GetBuildMilliseconds() const;
+            [[nodiscard]] float GetScanMilliseconds() const;
+            [[nodiscard]] float GetGravityMilliseconds() const;
+
+            // Leaf tables, nodes, sorted particles and accelerations, in bytes.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+        private:
+            int numParticles_;
+
+            std::unique_ptr<Shader> boundsShader_;
+            std::unique_ptr<Shader> histogramShader_;
+            std::unique_ptr<Shader> scatterShader_;
+            std::unique_ptr<Shader> leavesShader_;
+            std::unique_ptr<Shader> reduceShader_;
+            std::unique_ptr<Shader> gravityShader_;
+            std::unique_ptr<Shader> bruteForceShader_;
+            PrefixSum prefixSum_;
+
+            GLuint accelerationBuffer_;
+            GLuint boundsBuffer_;
+            GLuint leafStartBuffer_;
+            GLuint leafEndBuffer_;
+            GLuint particleBuffer_; // Sorted.
+            GLuint particleLeafBuffer_;
+            GLuint nodeBuffer_;
+
+            GPUTimer buildTimer_;
+            GPUTimer scanTimer_;
+            GPUTimer gravityTimer_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_PARTICLE_OCTREE_H
@@ -0,0 +1,37 @@
+
+#ifndef OPENGL_SAMPLES_PREFIX_SUM_H
+#define OPENGL_SAMPLES_PREFIX_SUM_H
+
+#include "pch.h"
+#include "shader.h"
+
+namespace OpenGL {
+
+    // Exclusive prefix sum over a large array of counts (such as the particles per grid cell), spread over many work
+    // groups: the sums of blocks of counts are computed first, then scanned, and added back to the scans within every
+    // block. Used by the counting sorts of ParticleGrid and ParticleOctree.
+    //
+    // The stages are compiled from prefix_sum.comp, and use shader storage buffer bindings 17 - 19.
+    class PrefixSum {
+        public:
+            // Throws std::runtime_error on compilation error.
+            explicit PrefixSum(int numElements);
+            ~PrefixSum();
+
+            // Replaces the counts in 'countBuffer' with their exclusive prefix sum, which is also written to 'startBuffer'.
+            // Both buffers need to hold at least 'numElements' unsigned integers.
+            void Scan(GLuint countBuffer, GLuint startBuffer);
+
+        private:
+            int numElements_;
+
+            std::unique_ptr<Shader> reduceShader_;
+            std::unique_ptr<Shader> blocksShader_;
+            std::unique_ptr<Shader> downsweepShader_;
+
+            GLuint blockSumBuffer_;
+    };
+
+}
+
+#endif //OPENGL_SAMPLES_PREFIX_SUM_H
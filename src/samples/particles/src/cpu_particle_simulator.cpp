@@ -0,0 +1,351 @@
+
+#include "pch.h"
+#include "cpu_particle_simulator.h"
+#include "utility.h"
+
+// Kernels for wider instruction sets are compiled for their own target with GCC / Clang, and selected at runtime based on
+// the CPU. MSVC has no per-function targets, so only the instruction sets enabled for the whole build (/arch) are used.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define SIMULATE_AVX2
+    #define SIMULATE_AVX512
+    #define TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define TARGET_AVX512 __attribute__((target("avx512f")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #if defined(__AVX2__)
+        #define SIMULATE_AVX2
+    #endif
+    #if defined(__AVX512F__)
+        #define SIMULATE_AVX512
+    #endif
+    #define TARGET_AVX2
+    #define TARGET_AVX512
+#endif
+
+#if defined(SIMULATE_AVX2) || defined(SIMULATE_AVX512)
+    #include <immintrin.h>
+#endif
+
+namespace OpenGL {
+
+    namespace {
+
+        // See particle.comp.
+        constexpr float epsilon = 0.001f;
+        constexpr float drag = -0.2f;
+        constexpr float gravity = 300.0f;
+
+        // Values shared by all particles in a step.
+        struct StepParameters {
+            float dt;
+            float halfDtSquared;
+            float dragFactor; // exp(drag * dt)
+            float strength;   // Zero when the center of gravity is not active.
+            glm::vec3 centerOfGravity;
+        };
+
+        struct ParticleArrays {
+            float* positions[3];
+            float* velocities[3];
+        };
+
+        void SimulateScalar(const StepParameters& parameters, const ParticleArrays& particles, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                float toCenterOfGravity[3];
+                for (int axis = 0; axis < 3; ++axis) {
+                    toCenterOfGravity[axis] = parameters.centerOfGravity[axis] - particles.positions[axis][i];
+                }
+
+                float distanceSquared = toCenterOfGravity[0] * toCenterOfGravity[0] + toCenterOfGravity[1] * toCenterOfGravity[1] + toCenterOfGravity[2] * toCenterOfGravity[2];
+                float distance = std::max(std::sqrt(distanceSquared), epsilon);
+                float inverseDistance = 1.0f / distance;
+                float scale = parameters.strength * inverseDistance * inverseDistance;
+
+                for (int axis = 0; axis < 3; ++axis) {
+                    float acceleration = toCenterOfGravity[axis] * scale;
+                    float velocity = particles.velocities[axis][i] * parameters.dragFactor;
+
+                    // Euler integration.
+                    particles.positions[axis][i] += parameters.dt * velocity + parameters.halfDtSquared * acceleration;
+                    particles.velocities[axis][i] = velocity + acceleration * parameters.dt;
+                }
+            }
+        }
+
+    #if defined(SIMULATE_AVX2)
+        TARGET_AVX2 void SimulateAVX2(const StepParameters& parameters, const ParticleArrays& particles, std::size_t begin, std::size_t end) {
+            const __m256 dt = _mm256_set1_ps(parameters.dt);
+            const __m256 halfDtSquared = _mm256_set1_ps(parameters.halfDtSquared);
+            const __m256 dragFactor = _mm256_set1_ps(parameters.dragFactor);
+            const __m256 strength = _mm256_set1_ps(parameters.strength);
+            const __m256 minimumDistance = _mm256_set1_ps(epsilon);
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 centerOfGravity[3] = { _mm256_set1_ps(parameters.centerOfGravity.x), _mm256_set1_ps(parameters.centerOfGravity.y), _mm256_set1_ps(parameters.centerOfGravity.z) };
+
+            std::size_t i = begin;
+            for (; i + 8 <= end; i += 8) {
+                __m256 toCenterOfGravity[3];
+                for (int axis = 0; axis < 3; ++axis) {
+                    toCenterOfGravity[axis] = _mm256_sub_ps(centerOfGravity[axis], _mm256_loadu_ps(particles.positions[axis] + i));
+                }
+
+                __m256 distanceSquared = _mm256_mul_ps(toCenterOfGravity[0], toCenterOfGravity[0]);
+                distanceSquared = _mm256_fmadd_ps(toCenterOfGravity[1], toCenterOfGravity[1], distanceSquared);
+                distanceSquared = _mm256_fmadd_ps(toCenterOfGravity[2], toCenterOfGravity[2], distanceSquared);
+
+                __m256 distance = _mm256_max_ps(_mm256_sqrt_ps(distanceSquared), minimumDistance);
+                __m256 inverseDistance = _mm256_div_ps(one, distance);
+                __m256 scale = _mm256_mul_ps(strength, _mm256_mul_ps(inverseDistance, inverseDistance));
+
+                for (int axis = 0; axis < 3; ++axis) {
+                    __m256 acceleration = _mm256_mul_ps(toCenterOfGravity[axis], scale);
+                    __m256 velocity = _mm256_mul_ps(_mm256_loadu_ps(particles.velocities[axis] + i), dragFactor);
+
+                    // Euler integration.
+                    __m256 position = _mm256_loadu_ps(particles.positions[axis] + i);
+                    position = _mm256_fmadd_ps(halfDtSquared, acceleration, _mm256_fmadd_ps(dt, velocity, position));
+
+                    _mm256_storeu_ps(particles.positions[axis] + i, position);
+                    _mm256_storeu_ps(particles.velocities[axis] + i, _mm256_fmadd_ps(acceleration, dt, velocity));
+                }
+            }
+
+            // Remaining particles.
+            SimulateScalar(parameters, particles, i, end);
+        }
+    #endif
+
+    #if defined(SIMULATE_AVX512)
+        TARGET_AVX512 void SimulateAVX512(const StepParameters& parameters, const ParticleArrays& particles, std::size_t begin, std::size_t end) {
+            const __m512 dt = _mm512_set1_ps(parameters.dt);
+            const __m512 halfDtSquared = _mm512_set1_ps(parameters.halfDtSquared);
+            const __m512 dragFactor = _mm512_set1_ps(parameters.dragFactor);
+            const __m512 strength = _mm512_set1_ps(parameters.strength);
+            const __m512 minimumDistance = _mm512_set1_ps(epsilon);
+            const __m512 one = _mm512_set1_ps(1.0f);
+            const __m512 centerOfGravity[3] = { _mm512_set1_ps(parameters.centerOfGravity.x), _mm512_set1_ps(parameters.centerOfGravity.y), _mm512_set1_ps(parameters.centerOfGravity.z) };
+
+            std::size_t i = begin;
+            for (; i + 16 <= end; i += 16) {
+                __m512 toCenterOfGravity[3];
+                for (int axis = 0; axis < 3; ++axis) {
+                    toCenterOfGravity[axis] = _mm512_sub_ps(centerOfGravity[axis], _mm512_loadu_ps(particles.positions[axis] + i));
+                }
+
+                __m512 distanceSquared = _mm512_mul_ps(toCenterOfGravity[0], toCenterOfGravity[0]);
+                distanceSquared = _mm512_fmadd_ps(toCenterOfGravity[1], toCenterOfGravity[1], distanceSquared);
+                distanceSquared = _mm512_fmadd_ps(toCenterOfGravity[2], toCenterOfGravity[2], distanceSquared);
+
+                __m512 distance = _mm512_max_ps(_mm512_sqrt_ps(distanceSquared), minimumDistance);
+                __m512 inverseDistance = _mm512_div_ps(one, distance);
+                __m512 scale = _mm512_mul_ps(strength, _mm512_mul_ps(inverseDistance, inverseDistance));
+
+                for (int axis = 0; axis < 3; ++axis) {
+                    __m512 acceleration = _mm512_mul_ps(toCenterOfGravity[axis], scale);
+                    __m512 velocity = _mm512_mul_ps(_mm512_loadu_ps(particles.velocities[axis] + i), dragFactor);
+
+                    // Euler integration.
+                    __m512 position = _mm512_loadu_ps(particles.positions[axis] + i);
+                    position = _mm512_fmadd_ps(halfDtSquared, acceleration, _mm512_fmadd_ps(dt, velocity, position));
+
+                    _mm512_storeu_ps(particles.positions[axis] + i, position);
+                    _mm512_storeu_ps(particles.velocities[axis] + i, _mm512_fmadd_ps(acceleration, dt, velocity));
+                }
+            }
+
+            // Remaining particles.
+            SimulateScalar(parameters, particles, i, end);
+        }
+    #endif
+
+        // Integer hash (PCG), for random numbers that only depend on the particle index and not on how particles are
+        // split into chunks.
+        std::uint32_t Hash(std::uint32_t value) {
+            std::uint32_t state = value * 747796405u + 2891336453u;
+            std::uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+            return (word >> 22u) ^ word;
+        }
+
+        // Uniform in [0, 1).
+        float Random(std::uint32_t seed, std::size_t index, std::uint32_t dimension) {
+            std::uint32_t hash = Hash(Hash(Hash(seed) ^ dimension) ^ static_cast<std::uint32_t>(index));
+            return static_cast<float>(hash >> 8u) / 16777216.0f;
+        }
+
+    }
+
+    CPUParticleSimulator::CPUParticleSimulator(std::size_t numParticles, unsigned numThreads) : numParticles_(numParticles),
+                                                                                                chunkSize_(0),
+                                                                                                instructionSet_(GetSupportedInstructionSet()),
+                                                                                                threadPool_(numThreads) {
+        for (int axis = 0; axis < 3; ++axis) {
+            positions_[axis] = std::unique_ptr<float[]>(new float[numParticles_]);
+            velocities_[axis] = std::unique_ptr<float[]>(new float[numParticles_]);
+        }
+
+        // A few chunks per thread balance the load between threads, while keeping the overhead per task small.
+        // Chunks are a multiple of the widest kernel, only the last chunk has particles left for the scalar kernel.
+        std::size_t numChunks = static_cast<std::size_t>(threadPool_.GetNumThreads()) * 4;
+        chunkSize_ = std::clamp<std::size_t>(numParticles_ / numChunks, 16384, 65536);
+        chunkSize_ = (chunkSize_ + 15) / 16 * 16;
+
+        ForEachChunk([this](std::size_t begin, std::size_t end) {
+            for (int axis = 0; axis < 3; ++axis) {
+                std::fill(positions_[axis].get() + begin, positions_[axis].get() + end, 0.0f);
+                std::fill(velocities_[axis].get() + begin, velocities_[axis].get() + end, 0.0f);
+            }
+        });
+    }
+
+    CPUParticleSimulator::~CPUParticleSimulator() {
+    }
+
+    void CPUParticleSimulator::Randomize(float radius, unsigned seed) {
+        ForEachChunk([this, radius, seed](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                // Uniform direction, and the cube root of the radius for a uniform density within the ball.
+                float z = 2.0f * Random(seed, i, 0) - 1.0f;
+                float angle = 2.0f * static_cast<float>(PI) * Random(seed, i, 1);
+                float distance = radius * std::cbrt(Random(seed, i, 2));
+                float xy = std::sqrt(std::max(1.0f - z * z, 0.0f));
+
+                positions_[0][i] = distance * xy * std::cos(angle);
+                positions_[1][i] = distance * xy * std::sin(angle);
+                positions_[2][i] = distance * z;
+
+                for (int axis = 0; axis < 3; ++axis) {
+                    velocities_[axis][i] = 0.0f;
+                }
+            }
+        });
+    }
+
+    void CPUParticleSimulator::SetParticles(const std::vector<Particle>& particles) {
+        if (particles.size() != numParticles_) {
+            throw std::runtime_error("Expected " + std::to_string(numParticles_) + " particles, got " + std::to_string(particles.size()) + ".");
+        }
+
+        ForEachChunk([this, &particles](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    positions_[axis][i] = particles[i].position[axis];
+                    velocities_[axis][i] = particles[i].velocity[axis];
+                }
+            }
+        });
+    }
+
+    std::vector<Particle> CPUParticleSimulator::GetParticles() const {
+        std::vector<Particle> particles(numParticles_);
+
+        for (std::size_t i = 0; i < numParticles_; ++i) {
+            particles[i].position = glm::vec4(positions_[0][i], positions_[1][i], positions_[2][i], 1.0f);
+            particles[i].velocity = glm::vec4(velocities_[0][i], velocities_[1][i], velocities_[2][i], 0.0f);
+        }
+
+        return particles;
+    }
+
+    void CPUParticleSimulator::Step(float dt, const glm::vec3& centerOfGravity, float isActive) {
+        StepParameters parameters { };
+        parameters.dt = dt;
+        parameters.halfDtSquared = 0.5f * dt * dt;
+        parameters.dragFactor = std::exp(drag * dt);
+        parameters.strength = gravity * isActive;
+        parameters.centerOfGravity = centerOfGravity;
+
+        ParticleArrays particles { };
+        for (int axis = 0; axis < 3; ++axis) {
+            particles.positions[axis] = positions_[axis].get();
+            particles.velocities[axis] = velocities_[axis].get();
+        }
+
+        void (*simulate)(const StepParameters&, const ParticleArrays&, std::size_t, std::size_t) = SimulateScalar;
+        switch (instructionSet_) {
+        #if defined(SIMULATE_AVX512)
+            case InstructionSet::AVX512:
+                simulate = SimulateAVX512;
+                break;
+        #endif
+        #if defined(SIMULATE_AVX2)
+            case InstructionSet::AVX2:
+                simulate = SimulateAVX2;
+                break;
+        #endif
+            default:
+                break;
+        }
+
+        ForEachChunk([simulate, &parameters, &particles](std::size_t begin, std::size_t end) {
+            simulate(parameters, particles, begin, end);
+        });
+    }
+
+    void CPUParticleSimulator::SetInstructionSet(InstructionSet instructionSet) {
+        instructionSet_ = std::min(instructionSet, GetSupportedInstructionSet());
+    }
+
+    InstructionSet CPUParticleSimulator::GetInstructionSet() const {
+        return instructionSet_;
+    }
+
+    std::size_t CPUParticleSimulator::GetNumParticles() const {
+        return numParticles_;
+    }
+
+    unsigned CPUParticleSimulator::GetNumThreads() const {
+        return threadPool_.GetNumThreads();
+    }
+
+    std::size_t CPUParticleSimulator::GetBytesPerParticle() const {
+        // Every position and velocity is read and written once.
+        return 2 * 6 * sizeof(float);
+    }
+
+    InstructionSet CPUParticleSimulator::GetSupportedInstructionSet() {
+    #if defined(SIMULATE_AVX512)
+        #if defined(__GNUC__) || defined(__clang__)
+            if (__builtin_cpu_supports("avx512f")) {
+                return InstructionSet::AVX512;
+            }
+        #else
+            return InstructionSet::AVX512;
+        #endif
+    #endif
+
+    #if defined(SIMULATE_AVX2)
+        #if defined(__GNUC__) || defined(__clang__)
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                return InstructionSet::AVX2;
+            }
+        #else
+            return InstructionSet::AVX2;
+        #endif
+    #endif
+
+        return InstructionSet::Scalar;
+    }
+
+    std::string CPUParticleSimulator::GetName(InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case InstructionSet::AVX2:
+                return "AVX2";
+            case InstructionSet::AVX512:
+                return "AVX-512";
+            default:
+                return "Scalar";
+        }
+    }
+
+    void CPUParticleSimulator::ForEachChunk(const std::function<void(std::size_t, std::size_t)>& function) {
+        for (std::size_t begin = 0; begin < numParticles_; begin += chunkSize_) {
+            std::size_t end = std::min(begin + chunkSize_, numParticles_);
+
+            threadPool_.Submit([&function, begin, end]() {
+                function(begin, end);
+            });
+        }
+
+        threadPool_.Wait();
+    }
+
+}
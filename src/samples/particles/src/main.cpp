@@ -1,11 +1,302 @@
 
 #include "pch.h"
 #include "particle.h"
+#include "particle_buffers.h"
 #include "shader.h"
 #include "camera.h"
 #include "utility.h"
+#include "image_capture.h"
+#include "frame_recorder.h"
+#include "gpu_timer.h"
+#include "readback.h"
+#include "cpu_particle_simulator.h"
+#include "particle_grid.h"
+#include "particle_octree.h"
+
+namespace {
+
+    // Returns the value following the given option on the command line, or 'fallback' if the option is not present.
+    int GetOption(const std::vector<std::string>& arguments, const std::string& option, int fallback) {
+        auto iterator = std::find(arguments.begin(), arguments.end(), option);
+        if (iterator == arguments.end() || iterator + 1 == arguments.end()) {
+            return fallback;
+        }
+
+        try {
+            return std::stoi(*(iterator + 1));
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value '" << *(iterator + 1) << "' for option " << option << ", using " << fallback << "." << std::endl;
+            return fallback;
+        }
+    }
+
+    GLFWwindow* CreateHiddenWindow() {
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW." << std::endl;
+            return nullptr;
+        }
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        GLFWwindow* window = glfwCreateWindow(64, 64, "GPU-Driven Particles", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window." << std::endl;
+            glfwTerminate();
+            return nullptr;
+        }
+
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Failed to initialize Glad (OpenGL)." << std::endl;
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return nullptr;
+        }
+
+        return window;
+    }
+
+    // Simulates the same particles with the CPU simulator and particle.comp, and prints how far they drifted apart.
+    bool CompareWithGPU(int numParticles, int numSteps, unsigned numThreads) {
+        GLFWwindow* window = CreateHiddenWindow();
+        if (!window) {
+            return false;
+        }
+
+        std::cout << "Renderer: " << (const char*)(glGetString(GL_RENDERER)) << std::endl;
+
+        std::vector<OpenGL::Particle> particles(numParticles);
+        for (OpenGL::Particle& particle : particles) {
+            particle.position = glm::vec4(glm::ballRand(200.0f), 1.0f);
+            particle.velocity = glm::vec4(0.0f);
+        }
+
+        float dt = 1.0f / 120.0f;
+        glm::vec3 centerOfGravity(20.0f, 10.0f, 0.0f);
+
+        {
+            OpenGL::ParticleBuffers particleBuffers(OpenGL::ParticleLayout::Std140, particles);
+            particleBuffers.Bind();
+
+            OpenGL::Shader simulationShader("Particle Simulation", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/particle.comp" });
+            simulationShader.Bind();
+            simulationShader.SetUniform("numParticles", numParticles);
+            simulationShader.SetUniform("dt", dt);
+            simulationShader.SetUniform("centerOfGravity", centerOfGravity);
+            simulationShader.SetUniform("isActive", 1.0f);
+
+            OpenGL::CPUParticleSimulator simulator(particles.size(), numThreads);
+            simulator.SetParticles(particles);
+
+            for (int step = 0; step < numSteps; ++step) {
+                glDispatchCompute((numParticles + 255) / 256, 1, 1);
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+                simulator.Step(dt, centerOfGravity, 1.0f);
+            }
+
+            std::vector<OpenGL::Particle> gpuParticles = particleBuffers.Download();
+            std::vector<OpenGL::Particle> cpuParticles = simulator.GetParticles();
+
+            // Particles passing close to the center of gravity amplify rounding differences, so both the largest and
+            // the average difference are reported.
+            double maximumDifference = 0.0;
+            double totalDifference = 0.0;
+            for (int i = 0; i < numParticles; ++i) {
+                double difference = glm::length(glm::vec3(gpuParticles[i].position) - glm::vec3(cpuParticles[i].position));
+                maximumDifference = std::max(maximumDifference, difference);
+                totalDifference += difference;
+            }
+
+            std::cout << "Position difference to the GPU after " << numSteps << " steps: " << totalDifference / static_cast<double>(glm::max(numParticles, 1)) << " (average), "
+                      << maximumDifference << " (maximum)." << std::endl;
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return true;
+    }
+
+    // CPU simulation benchmark, for machines without a GPU (see cpu_particle_simulator.h).
+    // Prints the simulation rate of every supported instruction set at 2, 20 and 200 million particles. With --compare,
+    // also checks the CPU simulation against the GPU (which requires an OpenGL context).
+    //     --cpu [--steps 10] [--threads <all cores>] [--max-particles 200000000] [--compare]
+    int RunCPUBenchmark(const std::vector<std::string>& arguments) {
+        int numSteps = glm::max(GetOption(arguments, "--steps", 10), 1);
+        unsigned numThreads = static_cast<unsigned>(glm::max(GetOption(arguments, "--threads", static_cast<int>(std::thread::hardware_concurrency())), 1));
+        int maxParticles = GetOption(arguments, "--max-particles", 200000000);
+
+        float dt = 1.0f / 120.0f;
+        glm::vec3 centerOfGravity(20.0f, 10.0f, 0.0f);
+
+        OpenGL::InstructionSet supportedInstructionSet = OpenGL::CPUParticleSimulator::GetSupportedInstructionSet();
+        std::cout << "Threads: " << numThreads << ", widest instruction set: " << OpenGL::CPUParticleSimulator::GetName(supportedInstructionSet) << std::endl;
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "%12s  %-10s  %12s  %14s  %10s", "Particles", "Kernel", "ms / step", "Mparticles / s", "GB / s");
+        std::cout << line << std::endl;
+
+        for (int numParticles : { 2000000, 20000000, 200000000 }) {
+            if (numParticles > maxParticles) {
+                continue;
+            }
+
+            std::unique_ptr<OpenGL::CPUParticleSimulator> simulator;
+            try {
+                simulator = std::make_unique<OpenGL::CPUParticleSimulator>(static_cast<std::size_t>(numParticles), numThreads);
+            }
+            catch (const std::bad_alloc&) {
+                std::cerr << "Not enough memory for " << numParticles << " particles." << std::endl;
+                continue;
+            }
+
+            simulator->Randomize(200.0f, 1337u);
+
+            for (int instructionSet = 0; instructionSet <= static_cast<int>(supportedInstructionSet); ++instructionSet) {
+                simulator->SetInstructionSet(static_cast<OpenGL::InstructionSet>(instructionSet));
+
+                // Fault in pages and wake up all worker threads before timing.
+                simulator->Step(dt, centerOfGravity, 1.0f);
+
+                auto start = std::chrono::steady_clock::now();
+                for (int step = 0; step < numSteps; ++step) {
+                    simulator->Step(dt, centerOfGravity, 1.0f);
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numSteps);
+
+                double particlesPerSecond = static_cast<double>(numParticles) / seconds;
+                double bytesPerSecond = particlesPerSecond * static_cast<double>(simulator->GetBytesPerParticle());
+
+                std::snprintf(line, sizeof(line), "%12d  %-10s  %12.2f  %14.1f  %10.2f", numParticles, OpenGL::CPUParticleSimulator::GetName(simulator->GetInstructionSet()).c_str(),
+                              seconds * 1000.0, particlesPerSecond / 1000000.0, bytesPerSecond / 1000000000.0);
+                std::cout << line << std::endl;
+            }
+        }
+
+        if (std::find(arguments.begin(), arguments.end(), "--compare") != arguments.end()) {
+            return CompareWithGPU(1000000, 120, numThreads) ? 0 : 1;
+        }
+
+        return 0;
+    }
+
+    // Barnes-Hut self-gravity against brute-force summation over all pairs of particles (see particle_octree.h).
+    // Prints the error of the approximated accelerations (relative to the exact ones) and the time per evaluation for a
+    // range of opening angles, at 4096, 16384 and 65536 particles.
+    //     --barnes-hut [--max-particles 65536]
+    int RunBarnesHutComparison(const std::vector<std::string>& arguments) {
+        int maxParticles = GetOption(arguments, "--max-particles", 65536);
+
+        GLFWwindow* window = CreateHiddenWindow();
+        if (!window) {
+            return 1;
+        }
+
+        std::cout << "Renderer: " << (const char*)(glGetString(GL_RENDERER)) << std::endl;
+
+        float gravitationalConstant = 0.05f;
+        float softening = 1.0f;
+
+        // Runs the given passes a few times after a warm-up, and returns the average time in milliseconds.
+        auto measure = [](const std::function<void()>& passes) -> double {
+            const int numRepetitions = 5;
+
+            passes();
+            glFinish();
+
+            auto start = std::chrono::steady_clock::now();
+            for (int repetition = 0; repetition < numRepetitions; ++repetition) {
+                passes();
+            }
+            glFinish();
+
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(numRepetitions);
+        };
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "%10s  %-13s  %10s  %10s  %10s  %10s", "Particles", "Method", "Build ms", "Force ms", "RMS error", "Max error");
+        std::cout << line << std::endl;
+
+        for (int numParticles : { 4096, 16384, 65536 }) {
+            if (numParticles > maxParticles) {
+                continue;
+            }
+
+            std::vector<OpenGL::Particle> particles(numParticles);
+            for (OpenGL::Particle& particle : particles) {
+                particle.position = glm::vec4(glm::ballRand(200.0f), 1.0f);
+                particle.velocity = glm::vec4(0.0f);
+            }
+
+            OpenGL::ParticleBuffers particleBuffers(OpenGL::ParticleLayout::Std140, particles);
+            particleBuffers.Bind();
+
+            OpenGL::ParticleOctree octree(OpenGL::ParticleLayout::Std140, numParticles);
+
+            // Brute force also reads the particles from the octree.
+            double buildMilliseconds = measure([&octree]() {
+                octree.Build(false);
+            });
+
+            double bruteForceMilliseconds = measure([&]() {
+                octree.ComputeGravityBruteForce(gravitationalConstant, softening);
+            });
+
+            std::vector<glm::vec4> exactAccelerations = octree.DownloadAccelerations();
+
+            std::snprintf(line, sizeof(line), "%10d  %-13s  %10.3f  %10.3f  %10s  %10s", numParticles, "brute force", buildMilliseconds, bruteForceMilliseconds, "-", "-");
+            std::cout << line << std::endl;
+
+            for (float openingAngle : { 0.25f, 0.5f, 0.75f, 1.0f }) {
+                double gravityMilliseconds = measure([&]() {
+                    octree.ComputeGravity(openingAngle, gravitationalConstant, softening, false);
+                });
+
+                std::vector<glm::vec4> accelerations = octree.DownloadAccelerations();
+
+                double totalSquaredError = 0.0;
+                double maximumError = 0.0;
+                for (int i = 0; i < numParticles; ++i) {
+                    glm::vec3 exactAcceleration = glm::vec3(exactAccelerations[i]);
+                    double error = glm::length(glm::vec3(accelerations[i]) - exactAcceleration) / glm::max(glm::length(exactAcceleration), 1e-12f);
+
+                    totalSquaredError += error * error;
+                    maximumError = std::max(maximumError, error);
+                }
+
+                char method[32];
+                std::snprintf(method, sizeof(method), "angle %.2f", openingAngle);
+
+                std::snprintf(line, sizeof(line), "%10d  %-13s  %10.3f  %10.3f  %10.2e  %10.2e", numParticles, method, buildMilliseconds, gravityMilliseconds,
+                              std::sqrt(totalSquaredError / static_cast<double>(numParticles)), maximumError);
+                std::cout << line << std::endl;
+            }
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 0;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    // CPU simulation, without a window (or a GPU).
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    if (std::find(arguments.begin(), arguments.end(), "--cpu") != arguments.end()) {
+        return RunCPUBenchmark(arguments);
+    }
+
+    // Self-gravity accuracy, with a hidden window.
+    if (std::find(arguments.begin(), arguments.end(), "--barnes-hut") != arguments.end()) {
+        return RunBarnesHutComparison(arguments);
+    }
 
-int main() {
     // Initialize GLFW.
     int initializationCode = glfwInit();
     if (!initializationCode) {
@@ -111,63 +402,227 @@ int main() {
     glGenBuffers(1, &vao);
     glGenVertexArrays(1, &vao);
 
-    GLuint ssbo;
-    glGenBuffers(1, &ssbo);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, particles.size() * sizeof(OpenGL::Particle), particles.data(), GL_STATIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo); // Binding 0.
+    // Particles are stored in one of several memory layouts, selectable at runtime (see ParticleLayout).
+    int particleLayout = static_cast<int>(OpenGL::ParticleLayout::Std140);
+    bool changeParticleLayout = false;
+
+    std::unique_ptr<OpenGL::ParticleBuffers> particleBuffers = std::make_unique<OpenGL::ParticleBuffers>(static_cast<OpenGL::ParticleLayout>(particleLayout), particles);
+    particleBuffers->Bind();
+
+    // Particle state only lives on the GPU from here on.
+    particles.clear();
+    particles.shrink_to_fit();
+
+    // Frustum culling (particle_cull.comp) compacts the indices of the visible particles into a buffer, and writes their
+    // number into an indirect draw command, so that only visible particles are rasterized.
+    bool useFrustumCulling = true;
+    int numVisibleParticles = numParticles; // Read back asynchronously, a few frames behind.
+
+    GLuint visibleIndexBuffer;
+    glGenBuffers(1, &visibleIndexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleIndexBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(numParticles * sizeof(GLuint)), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleIndexBuffer); // Binding 2.
+
+    // DrawArraysIndirectCommand: count (visible particles), instance count, first vertex, base instance.
+    GLuint drawCommand[4] = { 0, 1, 0, 0 };
+
+    GLuint drawCommandBuffer;
+    glGenBuffers(1, &drawCommandBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawCommandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(drawCommand), drawCommand, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, drawCommandBuffer); // Binding 3.
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    OpenGL::AsyncReadback visibleParticlesReadback;
+
+    // Particle-particle interactions (flocking) find their neighbours through a spatial hash grid, which is only
+    // allocated while they are enabled (see ParticleGrid).
+    bool useNeighborForces = false;
+    float interactionRadius = 2.0f; // Size of the grid cells.
+    int maxNeighbors = 32;
+    float flockingStrength = 1.0f;
+
+    std::unique_ptr<OpenGL::ParticleGrid> particleGrid;
+
+    // Attractors pull the particles towards fixed points, in addition to the center of gravity. All attractors are
+    // generated up front, and the first 'numAttractors' of them are active.
+    const int maxAttractors = 8192;
+    bool useAttractors = false;
+    int numAttractors = 1024;
+    float attractorStrength = 1.0f;
+
+    GLuint attractorBuffer;
+    glGenBuffers(1, &attractorBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, attractorBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(maxAttractors * sizeof(glm::vec4)), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, attractorBuffer); // Binding 9.
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
+    // Position (xyz) and relative strength (w) of every attractor.
+    auto randomizeAttractors = [&]() {
+        std::vector<glm::vec4> attractors(maxAttractors);
+        for (glm::vec4& attractor : attractors) {
+            attractor = glm::vec4(glm::ballRand(200.0f), glm::linearRand(0.5f, 1.5f));
+        }
+
+        glNamedBufferSubData(attractorBuffer, 0, static_cast<GLsizeiptr>(attractors.size() * sizeof(glm::vec4)), attractors.data());
+    };
+
+    randomizeAttractors();
+
+    // Self-gravity between all particles, approximated with Barnes-Hut over an octree that is only allocated while
+    // enabled (see ParticleOctree).
+    bool useSelfGravity = false;
+    float openingAngle = 0.5f;
+    float gravitationalConstant = 0.05f; // Scaled by the mass of a particle.
+    float softening = 1.0f;
+
+    std::unique_ptr<OpenGL::ParticleOctree> particleOctree;
+
     // FBO for screenshot purposes.
-    std::vector<float> blankTexture;
-    blankTexture.resize(width * height * 4, 0.0f);
-
-    GLuint outputTexture;
-    glGenTextures(1, &outputTexture);
-    glBindTexture(GL_TEXTURE_2D, outputTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // Depth buffer.
-    GLuint rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    // Attachments use immutable storage and are recreated (rather than respecified) when the window size changes.
+    // The color attachment is cleared every frame on the GPU, no blank data is uploaded from the CPU.
+    GLuint outputTexture = 0;
+    GLuint rbo = 0; // Depth buffer.
+    GLuint fbo = 0;
+
+    auto createRenderTargets = [&]() -> bool {
+        if (fbo) {
+            glDeleteFramebuffers(1, &fbo);
+            glDeleteRenderbuffers(1, &rbo);
+            glDeleteTextures(1, &outputTexture);
+        }
 
-    // Initialize custom framebuffer.
-    GLuint fbo;
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
+        glGenTextures(1, &outputTexture);
+        glBindTexture(GL_TEXTURE_2D, outputTexture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32F, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffers(1, &rbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
+
+        bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return isComplete;
+    };
+
+    // Initialize custom framebuffer.
+    if (!createRenderTargets()) {
         std::cerr << "Failed to initialize custom framebuffer on startup." << std::endl;
         return 1;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
     std::vector<GLenum> drawBuffers(1, GL_COLOR_ATTACHMENT0);
 
+    // Render targets are only recreated once the window size has settled, instead of on every frame of an interactive
+    // resize. Until then, the previous render targets are stretched over the window.
+    const double resizeDebounceTime = 0.1; // Seconds.
+    int pendingWidth = width;
+    int pendingHeight = height;
+    double pendingResizeTime = 0.0;
+
+    // Screenshots are read back and written to disk asynchronously.
+    OpenGL::ImageCapture imageCapture;
+
+    // Frame sequences are streamed to disk through a bounded queue.
+    OpenGL::FrameRecorder frameRecorder;
+    int recordingInterval = 1; // Capture every Nth frame.
+    int recordingFrameCounter = 0;
+
     // Timestep.
     float current;
     float previous = 0.0f;
     float dt = 0.0f;
 
+    // The simulation advances with a fixed timestep, independent of the frame rate. Every frame runs as many simulation
+    // steps as fit into the elapsed time (none, if rendering runs faster than the simulation), but at most
+    // 'maxStepsPerFrame' so that slow frames don't snowball into even slower ones.
+    int simulationRate = 120; // Steps per second.
+    int maxStepsPerFrame = 8;
+    float unsimulatedTime = 0.0f; // Seconds.
+    int numSimulationSteps = 0; // Steps run this frame.
+
+    // Simulation, neighbour forces, culling and rendering are timed separately.
+    OpenGL::GPUTimer simulationTimer;
+    OpenGL::GPUTimer flockingTimer;
+    OpenGL::GPUTimer cullingTimer;
+    OpenGL::GPUTimer renderTimer;
+
     // Compile shaders.
-    OpenGL::Shader shader { "Particle Shader", { "src/samples/particles/assets/shaders/particle.vert",
-                                                 "src/samples/particles/assets/shaders/particle.frag" } };
+    // All shaders are compiled for the current particle layout.
+    auto getParticleDefines = [&]() -> std::vector<OpenGL::Shader::ShaderDefine> {
+        return { { "PARTICLE_LAYOUT", std::to_string(particleLayout) } };
+    };
+
+    // Applies the accelerations of the particle grid and octree when neighbour interactions and self-gravity are enabled.
+    auto createSimulationShader = [&]() -> std::unique_ptr<OpenGL::Shader> {
+        std::vector<OpenGL::Shader::ShaderDefine> defines = getParticleDefines();
+        if (useNeighborForces) {
+            defines.emplace_back("NEIGHBOR_FORCES", "");
+        }
+
+        if (useAttractors) {
+            defines.emplace_back("ATTRACTORS", "");
+        }
+
+        if (useSelfGravity) {
+            defines.emplace_back("SELF_GRAVITY", "");
+        }
+
+        return std::make_unique<OpenGL::Shader>("Particle Simulation", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/particle.comp" }, defines);
+    };
+
+    auto createCullingShader = [&]() -> std::unique_ptr<OpenGL::Shader> {
+        return std::make_unique<OpenGL::Shader>("Particle Culling", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/particle_cull.comp" }, getParticleDefines());
+    };
+
+    // Reads particles through the visible indices when culling.
+    auto createParticleShader = [&]() -> std::unique_ptr<OpenGL::Shader> {
+        std::vector<OpenGL::Shader::ShaderDefine> defines = getParticleDefines();
+        if (useFrustumCulling) {
+            defines.emplace_back("FRUSTUM_CULLING", "");
+        }
+
+        return std::make_unique<OpenGL::Shader>("Particle Shader", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/particle.vert",
+                                                                                                        "src/samples/particles/assets/shaders/particle.frag" }, defines);
+    };
+
+    std::unique_ptr<OpenGL::Shader> simulationShader = createSimulationShader();
+    std::unique_ptr<OpenGL::Shader> cullingShader = createCullingShader();
+    std::unique_ptr<OpenGL::Shader> shader = createParticleShader();
 
-    shader.Bind();
     glBindVertexArray(vao);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
 
     while ((glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS) && (glfwWindowShouldClose(window) == 0)) {
         glfwPollEvents();
 
+        // Write out any screenshots / recorded frames the GPU has finished reading back.
+        imageCapture.Update();
+        frameRecorder.Update();
+        visibleParticlesReadback.Update();
+        simulationTimer.Update();
+        flockingTimer.Update();
+        cullingTimer.Update();
+        renderTimer.Update();
+
+        if (particleGrid) {
+            particleGrid->UpdateTimers();
+        }
+
+        if (particleOctree) {
+            particleOctree->UpdateTimers();
+        }
+
         // Start the Dear ImGui frame.
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -178,38 +633,26 @@ int main() {
         int tempHeight;
         glfwGetFramebufferSize(window, &tempWidth, &tempHeight);
 
-        if (tempWidth != width || tempHeight != height) {
-            // Window dimensions changed, resize content.
-            width = tempWidth;
-            height = tempHeight;
-
-            blankTexture.resize(width * height * 4, 0.0f); // Inserts or deletes elements appropriately.
-
-            // Reallocate FBO attachments with updated data storage size.
-            glBindTexture(GL_TEXTURE_2D, outputTexture);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-            glBindTexture(GL_TEXTURE_2D, 0);
-
-            glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        if (tempWidth != pendingWidth || tempHeight != pendingHeight) {
+            // Window is (still) being resized, restart the debounce timer.
+            pendingWidth = tempWidth;
+            pendingHeight = tempHeight;
+            pendingResizeTime = glfwGetTime();
+        }
 
-            // Reconstruct custom frame buffer.
-            // Note: not sure if this fully necessary, resizing doesn't happen every frame so the performance overhead is negligible.
-            glDeleteFramebuffers(1, &fbo);
+        // Minimized windows have a framebuffer size of zero, keep the existing render targets until the window is restored.
+        bool resizeSettled = glfwGetTime() - pendingResizeTime >= resizeDebounceTime;
 
-            glGenFramebuffers(1, &fbo);
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
+        if ((pendingWidth != width || pendingHeight != height) && resizeSettled && pendingWidth > 0 && pendingHeight > 0) {
+            // Window dimensions changed, resize content.
+            width = pendingWidth;
+            height = pendingHeight;
 
-            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            if (!createRenderTargets()) {
                 std::cerr << "Failed to reinitialize custom framebuffer on window resize." << std::endl;
                 break;
             }
 
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
             // Update viewport.
             glViewport(0, 0, width, height);
 
@@ -256,8 +699,6 @@ int main() {
             isRunning = !isRunning;
         }
 
-        shader.SetUniform("isRunning", isRunning ? 1.0f : 0.0f);
-
         previousPauseKeyState = currentPauseKeyState;
 
         // Mouse input.
@@ -304,7 +745,10 @@ int main() {
             initialInput = true;
         }
 
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+        glm::vec3 centerOfGravity(0.0f);
+        bool isActive = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+
+        if (isActive) {
             // Get ray that originates from the camera position in the rayDirection of the click.
             glm::dvec2 clickPosition;
             glfwGetCursorPos(window, &clickPosition.x, &clickPosition.y);
@@ -322,29 +766,163 @@ int main() {
             rayDirection = glm::vec4(glm::vec2(rayDirection), -1.0f, 0.0f);
             rayDirection = glm::normalize(glm::vec3(glm::inverse(camera.GetViewTransform()) * glm::vec4(rayDirection, 0.0f)));
 
-            glm::vec3 centerOfGravity = rayOrigin + rayDirection * 25.0f;
-            shader.SetUniform("centerOfGravity", centerOfGravity);
-            shader.SetUniform("isActive", 1.0f);
+            centerOfGravity = rayOrigin + rayDirection * 25.0f;
+        }
+
+        // Simulation.
+        numSimulationSteps = 0;
+
+        if (isRunning) {
+            float timestep = 1.0f / static_cast<float>(simulationRate);
+
+            unsimulatedTime += dt;
+            numSimulationSteps = glm::min(static_cast<int>(unsimulatedTime / timestep), maxStepsPerFrame);
+
+            if (numSimulationSteps == maxStepsPerFrame) {
+                // The simulation can't keep up, slow it down instead of carrying the remaining time over.
+                unsimulatedTime = 0.0f;
+            }
+            else {
+                unsimulatedTime -= static_cast<float>(numSimulationSteps) * timestep;
+            }
         }
         else {
-            shader.SetUniform("isActive", 0.0f);
+            // Resume without catching up on the paused time.
+            unsimulatedTime = 0.0f;
+        }
+
+        if (numSimulationSteps > 0) {
+            // Uniforms are kept by the shaders while switching between them every step.
+            simulationShader->Bind();
+            simulationShader->SetUniform("numParticles", numParticles);
+            simulationShader->SetUniform("dt", 1.0f / static_cast<float>(simulationRate));
+            simulationShader->SetUniform("centerOfGravity", centerOfGravity);
+            simulationShader->SetUniform("isActive", isActive ? 1.0f : 0.0f);
+
+            if (useAttractors) {
+                simulationShader->SetUniform("numAttractors", numAttractors);
+                simulationShader->SetUniform("attractorStrength", attractorStrength);
+            }
+
+            if (particleGrid) {
+                OpenGL::Shader& flockingShader = particleGrid->GetFlockingShader();
+                flockingShader.Bind();
+                flockingShader.SetUniform("numParticles", numParticles);
+                flockingShader.SetUniform("cellSize", interactionRadius);
+                flockingShader.SetUniform("maxNeighbors", maxNeighbors);
+                flockingShader.SetUniform("strength", flockingStrength);
+            }
+
+            for (int step = 0; step < numSimulationSteps; ++step) {
+                // Only the first step of every frame is timed, the cost of a step does not depend on the number of steps.
+                bool measure = step == 0;
+
+                // Neighbour forces of this step, from the particles of the previous one.
+                if (particleGrid) {
+                    particleGrid->Build(interactionRadius, measure);
+
+                    if (measure) {
+                        flockingTimer.Begin();
+                    }
+
+                    particleGrid->GetFlockingShader().Bind();
+                    glDispatchCompute((numParticles + 255) / 256, 1, 1); // 256 particles per work group.
+
+                    if (measure) {
+                        flockingTimer.End();
+                    }
+
+                    // Accelerations are read by the simulation.
+                    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                }
+
+                if (particleOctree) {
+                    particleOctree->Build(measure);
+                    particleOctree->ComputeGravity(openingAngle, gravitationalConstant, softening, measure);
+                }
+
+                // Force passes bind their own shaders.
+                simulationShader->Bind();
+
+                if (measure) {
+                    simulationTimer.Begin();
+                }
+
+                glDispatchCompute((numParticles + 255) / 256, 1, 1); // 256 particles per work group.
+
+                if (measure) {
+                    simulationTimer.End();
+                }
+
+                // Every step reads the particles written by the previous one, rendering reads the result.
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            }
+
+            simulationShader->Unbind();
+        }
+
+        // Frustum culling, runs every frame as the camera can move while the simulation is paused.
+        if (useFrustumCulling) {
+            cullingTimer.Begin();
+
+            // Reset the number of visible particles.
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawCommandBuffer);
+            glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+            cullingShader->Bind();
+            cullingShader->SetUniform("numParticles", numParticles);
+
+            std::array<glm::vec4, 6> frustumPlanes = camera.GetFrustumPlanes();
+            for (int i = 0; i < 6; ++i) {
+                cullingShader->SetUniform("frustumPlanes[" + std::to_string(i) + "]", frustumPlanes[i]);
+            }
+
+            glDispatchCompute((numParticles + 255) / 256, 1, 1); // 256 particles per work group.
+
+            // Visible indices are read by the vertex shader, their number by the draw command.
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+            cullingShader->Unbind();
+            cullingTimer.End();
         }
 
-        shader.SetUniform("dt", dt);
-        shader.SetUniform("cameraTransform", camera.GetCameraTransform());
+        // Rendering.
+        shader->Bind();
+        shader->SetUniform("cameraTransform", camera.GetCameraTransform());
 
         glBindFramebuffer(GL_FRAMEBUFFER, fbo);
         glDrawBuffers(1, drawBuffers.data());
 
-        // Rendering.
+        renderTimer.Begin();
+
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glDrawArrays(GL_POINTS, 0, numParticles);
+        if (useFrustumCulling) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+            glDrawArraysIndirect(GL_POINTS, nullptr);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+        else {
+            glDrawArrays(GL_POINTS, 0, numParticles);
+        }
 
-        // Necessary if particles data is being read from the SSBO on the CPU after rendering.
-        // glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        renderTimer.End();
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
+        shader->Unbind();
+
+        // The visible particle count of this frame is skipped while the readbacks of earlier frames are all still in flight.
+        if (useFrustumCulling && !visibleParticlesReadback.IsBusy()) {
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+            if (!visibleParticlesReadback.ReadBuffer(drawCommandBuffer, 0, sizeof(GLuint), [&numVisibleParticles](std::vector<unsigned char> data) {
+                GLuint count;
+                std::memcpy(&count, data.data(), sizeof(count));
+                numVisibleParticles = static_cast<int>(count);
+            })) {
+                std::cerr << "Failed to read back the number of visible particles." << std::endl;
+            }
+        }
 
         // Render final output to screen.
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -354,9 +932,19 @@ int main() {
 
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
+        // Output is stretched over the window while a resize is pending.
+        GLenum blitFilter = (tempWidth == width && tempHeight == height) ? GL_NEAREST : GL_LINEAR;
         glBlitFramebuffer(0, 0, width, height,
-                          0, 0, width, height,
-                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                          0, 0, tempWidth, tempHeight,
+                          GL_COLOR_BUFFER_BIT, blitFilter);
+
+        // Record every Nth frame.
+        if (frameRecorder.IsRecording()) {
+            if (recordingFrameCounter % recordingInterval == 0) {
+                frameRecorder.Capture(outputTexture, width, height);
+            }
+            ++recordingFrameCounter;
+        }
 
         // Sample overview and statistics.
         if (ImGui::Begin("Sample Overview")) {
@@ -365,33 +953,245 @@ int main() {
             ImGui::Text("Render time:");
             ImGui::Text("%.3f ms/frame (%.1f FPS)", dt * 1000.0f, 1.0f / dt);
 
+            // GPU time.
+            float simulationMilliseconds = simulationTimer.GetAverageMilliseconds();
+            float renderMilliseconds = renderTimer.GetAverageMilliseconds();
+
+            ImGui::Text("Simulation: %.3f ms/step (%i steps this frame)", simulationMilliseconds, numSimulationSteps);
+            if (particleGrid) {
+                ImGui::Text("Grid build: %.3f ms/step (hash %.3f, scan %.3f, scatter %.3f)",
+                            particleGrid->GetHistogramMilliseconds() + particleGrid->GetScanMilliseconds() + particleGrid->GetScatterMilliseconds(),
+                            particleGrid->GetHistogramMilliseconds(), particleGrid->GetScanMilliseconds(), particleGrid->GetScatterMilliseconds());
+                ImGui::Text("Flocking: %.3f ms/step", flockingTimer.GetAverageMilliseconds());
+            }
+            if (particleOctree) {
+                ImGui::Text("Octree build: %.3f ms/step (scan %.3f)", particleOctree->GetBuildMilliseconds(), particleOctree->GetScanMilliseconds());
+                ImGui::Text("Self-gravity: %.3f ms/step", particleOctree->GetGravityMilliseconds());
+            }
+            if (useFrustumCulling) {
+                ImGui::Text("Frustum culling: %.3f ms", cullingTimer.GetAverageMilliseconds());
+            }
+            ImGui::Text("Particle rendering: %.3f ms", renderMilliseconds);
+
+            ImGui::Text("Simulation rate (steps per second):");
+            if (ImGui::SliderInt("##simulationRate", &simulationRate, 10, 480)) {
+                // Manual input can go outside the valid range.
+                simulationRate = glm::clamp(simulationRate, 10, 480);
+            }
+
+            ImGui::Text("Maximum steps per frame:");
+            if (ImGui::SliderInt("##maxStepsPerFrame", &maxStepsPerFrame, 1, 16)) {
+                // Manual input can go outside the valid range.
+                maxStepsPerFrame = glm::clamp(maxStepsPerFrame, 1, 16);
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Frustum culling?", &useFrustumCulling)) {
+                shader = createParticleShader();
+                cullingTimer.Reset();
+                numVisibleParticles = numParticles;
+            }
+
+            if (useFrustumCulling) {
+                ImGui::Text("Visible particles: %i (%.1f%%)", numVisibleParticles, 100.0f * static_cast<float>(numVisibleParticles) / static_cast<float>(numParticles));
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Neighbour interactions (flocking)?", &useNeighborForces)) {
+                if (useNeighborForces) {
+                    particleGrid = std::make_unique<OpenGL::ParticleGrid>(static_cast<OpenGL::ParticleLayout>(particleLayout), numParticles);
+                }
+                else {
+                    particleGrid.reset();
+                }
+
+                simulationShader = createSimulationShader();
+                simulationTimer.Reset();
+                flockingTimer.Reset();
+            }
+
+            if (particleGrid) {
+                ImGui::Text("Interaction radius:");
+                if (ImGui::SliderFloat("##interactionRadius", &interactionRadius, 0.5f, 10.0f)) {
+                    // Manual input can go outside the valid range.
+                    interactionRadius = glm::clamp(interactionRadius, 0.5f, 10.0f);
+                }
+
+                ImGui::Text("Flocking strength:");
+                if (ImGui::SliderFloat("##flockingStrength", &flockingStrength, 0.0f, 10.0f)) {
+                    // Manual input can go outside the valid range.
+                    flockingStrength = glm::clamp(flockingStrength, 0.0f, 10.0f);
+                }
+
+                ImGui::Text("Maximum neighbours per particle:");
+                if (ImGui::SliderInt("##maxNeighbors", &maxNeighbors, 1, 128)) {
+                    // Manual input can go outside the valid range.
+                    maxNeighbors = glm::clamp(maxNeighbors, 1, 128);
+                }
+
+                ImGui::Text("Grid memory: %.1f MB", static_cast<double>(particleGrid->GetMemoryUsage()) / (1024.0 * 1024.0));
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Attractors?", &useAttractors)) {
+                simulationShader = createSimulationShader();
+                simulationTimer.Reset();
+            }
+
+            if (useAttractors) {
+                ImGui::Text("Number of attractors:");
+                if (ImGui::SliderInt("##numAttractors", &numAttractors, 1, maxAttractors)) {
+                    // Manual input can go outside the valid range.
+                    numAttractors = glm::clamp(numAttractors, 1, maxAttractors);
+                }
+
+                ImGui::Text("Attractor strength:");
+                if (ImGui::SliderFloat("##attractorStrength", &attractorStrength, 0.0f, 20.0f)) {
+                    // Manual input can go outside the valid range.
+                    attractorStrength = glm::clamp(attractorStrength, 0.0f, 20.0f);
+                }
+
+                if (ImGui::Button("Randomize Attractors")) {
+                    randomizeAttractors();
+                }
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Self-gravity (Barnes-Hut)?", &useSelfGravity)) {
+                if (useSelfGravity) {
+                    particleOctree = std::make_unique<OpenGL::ParticleOctree>(static_cast<OpenGL::ParticleLayout>(particleLayout), numParticles);
+                }
+                else {
+                    particleOctree.reset();
+                }
+
+                simulationShader = createSimulationShader();
+                simulationTimer.Reset();
+            }
+
+            if (particleOctree) {
+                // Smaller angles are more accurate, but open more nodes.
+                ImGui::Text("Opening angle:");
+                if (ImGui::SliderFloat("##openingAngle", &openingAngle, 0.1f, 1.5f)) {
+                    // Manual input can go outside the valid range.
+                    openingAngle = glm::clamp(openingAngle, 0.1f, 1.5f);
+                }
+
+                ImGui::Text("Gravitational constant:");
+                if (ImGui::SliderFloat("##gravitationalConstant", &gravitationalConstant, 0.0f, 0.5f)) {
+                    // Manual input can go outside the valid range.
+                    gravitationalConstant = glm::clamp(gravitationalConstant, 0.0f, 0.5f);
+                }
+
+                ImGui::Text("Softening length:");
+                if (ImGui::SliderFloat("##softening", &softening, 0.1f, 10.0f)) {
+                    // Manual input can go outside the valid range.
+                    softening = glm::clamp(softening, 0.1f, 10.0f);
+                }
+
+                ImGui::Text("Octree memory: %.1f MB", static_cast<double>(particleOctree->GetMemoryUsage()) / (1024.0 * 1024.0));
+            }
+
+            ImGui::Separator();
+
+            ImGui::Text("Particle layout:");
+            if (ImGui::Combo("##particleLayout", &particleLayout, "std140 (vec4)\0std430 (packed vec3)\0SoA\0SoA, half precision velocity\0")) {
+                changeParticleLayout = true;
+            }
+
+            // Bandwidth is estimated from the bytes every pass has to read / write, and its GPU time.
+            double numBytesSimulated = static_cast<double>(particleBuffers->GetSimulationBytesPerParticle()) * static_cast<double>(numParticles);
+            // Only visible particles are fetched when culling, through their index.
+            double numBytesRendered = useFrustumCulling ? static_cast<double>(particleBuffers->GetRenderBytesPerParticle() + sizeof(GLuint)) * static_cast<double>(numVisibleParticles)
+                                                        : static_cast<double>(particleBuffers->GetRenderBytesPerParticle()) * static_cast<double>(numParticles);
+            double megabyte = 1024.0 * 1024.0;
+
+            ImGui::Text("Particle memory: %.1f MB (%i bytes per particle)", static_cast<double>(particleBuffers->GetMemoryUsage()) / megabyte,
+                        static_cast<int>(particleBuffers->GetMemoryUsage() / static_cast<std::size_t>(numParticles)));
+            ImGui::Text("Simulation traffic: %.1f MB/step (%.1f GB/s)", numBytesSimulated / megabyte, simulationMilliseconds > 0.0f ? numBytesSimulated / (simulationMilliseconds * 1000000.0) : 0.0);
+            ImGui::Text("Rendering traffic: %.1f MB/frame (%.1f GB/s)", numBytesRendered / megabyte, renderMilliseconds > 0.0f ? numBytesRendered / (renderMilliseconds * 1000000.0) : 0.0);
+
+            ImGui::Separator();
+
             static char outputFilename[256] = { "result" };
 
             if (ImGui::Button("Take Screenshot")) {
                 static std::string outputDirectory = "src/samples/particles/data/screenshots/";
 
-                if (!std::filesystem::exists(outputDirectory)) {
-                    // Create output directory if it doesn't exist.
-                    std::filesystem::create_directory(outputDirectory);
+                // Read in OpenGL texture data asynchronously, final output image is saved once the GPU has caught up.
+                if (!imageCapture.Capture(outputTexture, width, height, outputDirectory + std::string(outputFilename))) {
+                    std::cerr << "Failed to take screenshot, too many captures are already in progress." << std::endl;
                 }
+            }
 
-                // Save final output image.
-                int channels = 4;
-                std::vector<unsigned char> pixels(width * height * channels);
-
-                // Read in OpenGL texture data.
-                glBindTexture(GL_TEXTURE_2D, outputTexture);
-                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-                glBindTexture(GL_TEXTURE_2D, 0);
-
-                stbi_flip_vertically_on_write(true);
-                stbi_write_png(std::string(outputDirectory + std::string(outputFilename) + ".png").c_str(), width, height, channels, pixels.data(), 0);
-                stbi_write_jpg(std::string(outputDirectory + std::string(outputFilename) + ".jpg").c_str(), width, height, channels, pixels.data(), 100);
+            int numPendingCaptures = imageCapture.GetNumPendingCaptures();
+            if (numPendingCaptures > 0) {
+                ImGui::SameLine();
+                ImGui::Text("Saving (%i)...", numPendingCaptures);
             }
 
             ImGui::Text("Filename:");
             ImGui::InputText("##outputFilename", outputFilename, 256);
 
+            ImGui::Separator();
+
+            // Frame sequence / video recording.
+            static int recordingFormat = static_cast<int>(OpenGL::FrameRecorder::Format::PNGSequence);
+            static int overflowPolicy = static_cast<int>(OpenGL::FrameRecorder::OverflowPolicy::Block);
+            static int maxQueuedFrames = 8;
+            static int framesPerSecond = 30;
+
+            ImGui::Text("Recording format:");
+            ImGui::Combo("##recordingFormat", &recordingFormat, "PNG sequence\0Y4M video\0");
+
+            ImGui::Text("Capture every N frames:");
+            if (ImGui::SliderInt("##recordingInterval", &recordingInterval, 1, 60)) {
+                // Manual input can go outside the valid range.
+                recordingInterval = glm::clamp(recordingInterval, 1, 60);
+            }
+
+            ImGui::Text("Playback rate (FPS):");
+            if (ImGui::SliderInt("##framesPerSecond", &framesPerSecond, 1, 120)) {
+                // Manual input can go outside the valid range.
+                framesPerSecond = glm::clamp(framesPerSecond, 1, 120);
+            }
+
+            ImGui::Text("When the disk falls behind:");
+            ImGui::Combo("##overflowPolicy", &overflowPolicy, "Wait (back-pressure)\0Drop frames\0");
+
+            ImGui::Text("Maximum queued frames:");
+            if (ImGui::SliderInt("##maxQueuedFrames", &maxQueuedFrames, 1, 64)) {
+                // Manual input can go outside the valid range.
+                maxQueuedFrames = glm::clamp(maxQueuedFrames, 1, 64);
+            }
+
+            if (!frameRecorder.IsRecording()) {
+                if (ImGui::Button("Start Recording")) {
+                    static std::string recordingDirectory = "src/samples/particles/data/recordings/";
+
+                    if (!frameRecorder.Start(recordingDirectory + std::string(outputFilename), static_cast<OpenGL::FrameRecorder::Format>(recordingFormat), width, height, framesPerSecond,
+                                             static_cast<OpenGL::FrameRecorder::OverflowPolicy>(overflowPolicy), static_cast<std::size_t>(maxQueuedFrames))) {
+                        std::cerr << "Failed to start recording." << std::endl;
+                    }
+
+                    recordingFrameCounter = 0;
+                }
+            }
+            else {
+                if (ImGui::Button("Stop Recording")) {
+                    frameRecorder.Stop();
+                }
+            }
+
+            if (frameRecorder.IsRecording() || frameRecorder.GetNumFramesCaptured() > 0) {
+                ImGui::Text("Frames: %i captured, %i written, %i dropped", frameRecorder.GetNumFramesCaptured(), frameRecorder.GetNumFramesWritten(), frameRecorder.GetNumFramesDropped());
+                ImGui::Text("Pending: %i frames (at most %.1f MB)", frameRecorder.GetNumFramesPending(), static_cast<float>(frameRecorder.GetMaximumMemoryUsage()) / (1024.0f * 1024.0f));
+            }
+
             ImGui::PopStyleColor();
         }
         ImGui::End();
@@ -407,6 +1207,33 @@ int main() {
             io.WantSaveIniSettings = false;
         }
 
+        if (changeParticleLayout) {
+            // Particle state is carried over to the new layout through the CPU.
+            std::vector<OpenGL::Particle> state = particleBuffers->Download();
+
+            particleBuffers = std::make_unique<OpenGL::ParticleBuffers>(static_cast<OpenGL::ParticleLayout>(particleLayout), state);
+            particleBuffers->Bind();
+
+            simulationShader = createSimulationShader();
+            cullingShader = createCullingShader();
+            shader = createParticleShader();
+
+            if (particleGrid) {
+                particleGrid = std::make_unique<OpenGL::ParticleGrid>(static_cast<OpenGL::ParticleLayout>(particleLayout), numParticles);
+            }
+
+            if (particleOctree) {
+                particleOctree = std::make_unique<OpenGL::ParticleOctree>(static_cast<OpenGL::ParticleLayout>(particleLayout), numParticles);
+            }
+
+            // Timings still in flight were measured with the previous layout.
+            simulationTimer.Reset();
+            flockingTimer.Reset();
+            cullingTimer.Reset();
+            renderTimer.Reset();
+            changeParticleLayout = false;
+        }
+
         current = (float)glfwGetTime();
         dt = current - previous;
         previous = current;
@@ -414,15 +1241,23 @@ int main() {
         glfwSwapBuffers(window);
     }
 
-    shader.Unbind();
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
     glBindVertexArray(0);
 
     // Shutdown.
+    imageCapture.Flush();
+    frameRecorder.Stop();
+
     glDeleteFramebuffers(1, &fbo);
     glDeleteRenderbuffers(1, &rbo);
     glDeleteTextures(1, &outputTexture);
-    glDeleteBuffers(1, &ssbo);
+    particleBuffers.reset();
+    particleGrid.reset();
+    particleOctree.reset();
+    visibleParticlesReadback.Flush();
+    glDeleteBuffers(1, &visibleIndexBuffer);
+    glDeleteBuffers(1, &drawCommandBuffer);
+    glDeleteBuffers(1, &attractorBuffer);
     glDeleteVertexArrays(1, &vao);
 
     ImGui::SaveIniSettingsToDisk(imGuiIni.c_str());
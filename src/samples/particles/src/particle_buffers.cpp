@@ -0,0 +1,188 @@
+
+#include "pch.h"
+#include "particle_buffers.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        // Squared speed and largest velocity component, which determine the color of a particle, packed into the w
+        // component of the position (see particle.vert).
+        float PackColorInputs(const glm::vec3& velocity) {
+            glm::vec2 inputs(glm::dot(velocity, velocity), glm::max(velocity.x, glm::max(velocity.y, velocity.z)));
+            return glm::uintBitsToFloat(glm::packHalf2x16(inputs));
+        }
+
+    }
+
+    ParticleBuffers::ParticleBuffers(ParticleLayout layout, const std::vector<Particle>& particles) : layout_(layout),
+                                                                                                   numParticles_(static_cast<int>(particles.size())),
+                                                                                                   buffers_ { 0, 0 } {
+        std::size_t numParticles = particles.size();
+
+        auto createBuffer = [](GLuint& buffer, std::size_t size, const void* data) {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(size), data, GL_STATIC_DRAW);
+        };
+
+        switch (layout_) {
+            case ParticleLayout::Std140: {
+                createBuffer(buffers_[0], numParticles * sizeof(Particle), particles.data());
+                break;
+            }
+            case ParticleLayout::Std430: {
+                std::vector<float> data(numParticles * 6);
+                for (std::size_t i = 0; i < numParticles; ++i) {
+                    std::memcpy(&data[i * 6 + 0], glm::value_ptr(particles[i].position), 3 * sizeof(float));
+                    std::memcpy(&data[i * 6 + 3], glm::value_ptr(particles[i].velocity), 3 * sizeof(float));
+                }
+
+                createBuffer(buffers_[0], data.size() * sizeof(float), data.data());
+                break;
+            }
+            case ParticleLayout::SoA:
+            case ParticleLayout::SoAHalfVelocity: {
+                std::vector<glm::vec4> positions(numParticles);
+                for (std::size_t i = 0; i < numParticles; ++i) {
+                    positions[i] = glm::vec4(glm::vec3(particles[i].position), PackColorInputs(particles[i].velocity));
+                }
+
+                createBuffer(buffers_[0], positions.size() * sizeof(glm::vec4), positions.data());
+
+                if (layout_ == ParticleLayout::SoA) {
+                    std::vector<float> velocities(numParticles * 3);
+                    for (std::size_t i = 0; i < numParticles; ++i) {
+                        std::memcpy(&velocities[i * 3], glm::value_ptr(particles[i].velocity), 3 * sizeof(float));
+                    }
+
+                    createBuffer(buffers_[1], velocities.size() * sizeof(float), velocities.data());
+                }
+                else {
+                    // xy, z (and padding).
+                    std::vector<GLuint> velocities(numParticles * 2);
+                    for (std::size_t i = 0; i < numParticles; ++i) {
+                        const glm::vec4& velocity = particles[i].velocity;
+                        velocities[i * 2 + 0] = glm::packHalf2x16(glm::vec2(velocity.x, velocity.y));
+                        velocities[i * 2 + 1] = glm::packHalf2x16(glm::vec2(velocity.z, 0.0f));
+                    }
+
+                    createBuffer(buffers_[1], velocities.size() * sizeof(GLuint), velocities.data());
+                }
+                break;
+            }
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ParticleBuffers::~ParticleBuffers() {
+        glDeleteBuffers(2, buffers_);
+    }
+
+    void ParticleBuffers::Bind() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers_[0]); // Binding 0.
+
+        if (buffers_[1]) {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers_[1]); // Binding 1.
+        }
+    }
+
+    std::vector<Particle> ParticleBuffers::Download() const {
+        std::size_t numParticles = static_cast<std::size_t>(numParticles_);
+        std::vector<Particle> particles(numParticles);
+
+        // Particles are written by shader storage buffer writes.
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        switch (layout_) {
+            case ParticleLayout::Std140: {
+                glGetNamedBufferSubData(buffers_[0], 0, static_cast<GLsizeiptr>(numParticles * sizeof(Particle)), particles.data());
+                break;
+            }
+            case ParticleLayout::Std430: {
+                std::vector<float> data(numParticles * 6);
+                glGetNamedBufferSubData(buffers_[0], 0, static_cast<GLsizeiptr>(data.size() * sizeof(float)), data.data());
+
+                for (std::size_t i = 0; i < numParticles; ++i) {
+                    particles[i].position = glm::vec4(data[i * 6 + 0], data[i * 6 + 1], data[i * 6 + 2], 1.0f);
+                    particles[i].velocity = glm::vec4(data[i * 6 + 3], data[i * 6 + 4], data[i * 6 + 5], 0.0f);
+                }
+                break;
+            }
+            case ParticleLayout::SoA:
+            case ParticleLayout::SoAHalfVelocity: {
+                std::vector<glm::vec4> positions(numParticles);
+                glGetNamedBufferSubData(buffers_[0], 0, static_cast<GLsizeiptr>(positions.size() * sizeof(glm::vec4)), positions.data());
+
+                for (std::size_t i = 0; i < numParticles; ++i) {
+                    particles[i].position = glm::vec4(glm::vec3(positions[i]), 1.0f);
+                }
+
+                if (layout_ == ParticleLayout::SoA) {
+                    std::vector<float> velocities(numParticles * 3);
+                    glGetNamedBufferSubData(buffers_[1], 0, static_cast<GLsizeiptr>(velocities.size() * sizeof(float)), velocities.data());
+
+                    for (std::size_t i = 0; i < numParticles; ++i) {
+                        particles[i].velocity = glm::vec4(velocities[i * 3 + 0], velocities[i * 3 + 1], velocities[i * 3 + 2], 0.0f);
+                    }
+                }
+                else {
+                    std::vector<GLuint> velocities(numParticles * 2);
+                    glGetNamedBufferSubData(buffers_[1], 0, static_cast<GLsizeiptr>(velocities.size() * sizeof(GLuint)), velocities.data());
+
+                    for (std::size_t i = 0; i < numParticles; ++i) {
+                        particles[i].velocity = glm::vec4(glm::unpackHalf2x16(velocities[i * 2 + 0]), glm::unpackHalf2x16(velocities[i * 2 + 1]).x, 0.0f);
+                    }
+                }
+                break;
+            }
+        }
+
+        return particles;
+    }
+
+    ParticleLayout ParticleBuffers::GetLayout() const {
+        return layout_;
+    }
+
+    int ParticleBuffers::GetNumParticles() const {
+        return numParticles_;
+    }
+
+    std::size_t ParticleBuffers::GetMemoryUsage() const {
+        return static_cast<std::size_t>(numParticles_) * (GetPositionSize() + GetVelocitySize());
+    }
+
+    std::size_t ParticleBuffers::GetSimulationBytesPerParticle() const {
+        // Every particle is read and written once.
+        return 2 * (GetPositionSize() + GetVelocitySize());
+    }
+
+    std::size_t ParticleBuffers::GetRenderBytesPerParticle() const {
+        return GetPositionSize();
+    }
+
+    std::size_t ParticleBuffers::GetPositionSize() const {
+        switch (layout_) {
+            case ParticleLayout::Std140:
+                return sizeof(Particle); // Velocities are interleaved with positions.
+            case ParticleLayout::Std430:
+                return 6 * sizeof(float);
+            default:
+                return sizeof(glm::vec4);
+        }
+    }
+
+    std::size_t ParticleBuffers::GetVelocitySize() const {
+        switch (layout_) {
+            case ParticleLayout::SoA:
+                return 3 * sizeof(float);
+            case ParticleLayout::SoAHalfVelocity:
+                return 2 * sizeof(GLuint);
+            default:
+                return 0; // Interleaved with positions.
+        }
+    }
+
+}
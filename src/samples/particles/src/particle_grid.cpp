@@ -0,0 +1,160 @@
+
+#include "pch.h"
+#include "particle_grid.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        const int workGroupSize = 256; // Particles per work group, see particle_grid.comp.
+        const int numGridCells = 1 << 20; // Hash buckets.
+
+        const std::size_t gridParticleSize = 32; // See GridParticle in particle_grid.comp.
+
+    }
+
+    ParticleGrid::ParticleGrid(ParticleLayout layout, int numParticles) : numParticles_(numParticles),
+                                                                          prefixSum_(numGridCells),
+                                                                          cellStartBuffer_(0),
+                                                                          cellEndBuffer_(0),
+                                                                          particleBuffer_(0),
+                                                                          particleCellBuffer_(0),
+                                                                          accelerationBuffer_(0) {
+        auto createStage = [layout](const std::string& stage) {
+            return std::make_unique<Shader>("Particle Grid (" + stage + ")", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/particle_grid.comp" },
+                                            std::vector<Shader::ShaderDefine> { { stage, "1" },
+                                                                                { "PARTICLE_LAYOUT", std::to_string(static_cast<int>(layout)) },
+                                                                                { "NUM_GRID_CELLS", std::to_string(numGridCells) } });
+        };
+
+        histogramShader_ = createStage("GRID_HISTOGRAM");
+        scatterShader_ = createStage("GRID_SCATTER");
+        flockingShader_ = createStage("FLOCKING");
+
+        std::size_t count = static_cast<std::size_t>(numParticles_);
+
+        auto createBuffer = [](GLuint& buffer, std::size_t size) {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_COPY);
+        };
+
+        createBuffer(cellStartBuffer_, numGridCells * sizeof(GLuint));
+        createBuffer(cellEndBuffer_, numGridCells * sizeof(GLuint));
+        createBuffer(particleBuffer_, count * gridParticleSize);
+        createBuffer(particleCellBuffer_, count * sizeof(GLuint));
+        createBuffer(accelerationBuffer_, count * sizeof(glm::vec4));
+
+        // Accelerations are only written by force kernels.
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32F, GL_RED, GL_FLOAT, nullptr);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ParticleGrid::~ParticleGrid() {
+        glDeleteBuffers(1, &cellStartBuffer_);
+        glDeleteBuffers(1, &cellEndBuffer_);
+        glDeleteBuffers(1, &particleBuffer_);
+        glDeleteBuffers(1, &particleCellBuffer_);
+        glDeleteBuffers(1, &accelerationBuffer_);
+    }
+
+    void ParticleGrid::Build(float cellSize, bool measure) {
+        Bind();
+
+        GLuint numWorkGroups = static_cast<GLuint>((numParticles_ + workGroupSize - 1) / workGroupSize);
+
+        // Count the particles per bucket.
+        if (measure) {
+            histogramTimer_.Begin();
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellEndBuffer_);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        histogramShader_->Bind();
+        histogramShader_->SetUniform("numParticles", numParticles_);
+        histogramShader_->SetUniform("cellSize", cellSize);
+        glDispatchCompute(numWorkGroups, 1, 1);
+
+        if (measure) {
+            histogramTimer_.End();
+        }
+
+        // Every stage reads what the previous one wrote.
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // Offsets of the buckets.
+        if (measure) {
+            scanTimer_.Begin();
+        }
+
+        prefixSum_.Scan(cellEndBuffer_, cellStartBuffer_);
+
+        if (measure) {
+            scanTimer_.End();
+        }
+
+        // Sort.
+        if (measure) {
+            scatterTimer_.Begin();
+        }
+
+        // The prefix sum binds its own buffers.
+        Bind();
+
+        scatterShader_->Bind();
+        scatterShader_->SetUniform("numParticles", numParticles_);
+        glDispatchCompute(numWorkGroups, 1, 1);
+
+        if (measure) {
+            scatterTimer_.End();
+        }
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        scatterShader_->Unbind();
+    }
+
+    void ParticleGrid::Bind() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, cellStartBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, cellEndBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, particleBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, particleCellBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, accelerationBuffer_);
+    }
+
+    Shader& ParticleGrid::GetFlockingShader() {
+        return *flockingShader_;
+    }
+
+    void ParticleGrid::UpdateTimers() {
+        histogramTimer_.Update();
+        scanTimer_.Update();
+        scatterTimer_.Update();
+    }
+
+    void ParticleGrid::ResetTimers() {
+        histogramTimer_.Reset();
+        scanTimer_.Reset();
+        scatterTimer_.Reset();
+    }
+
+    float ParticleGrid::GetHistogramMilliseconds() const {
+        return histogramTimer_.GetAverageMilliseconds();
+    }
+
+    float ParticleGrid::GetScanMilliseconds() const {
+        return scanTimer_.GetAverageMilliseconds();
+    }
+
+    float ParticleGrid::GetScatterMilliseconds() const {
+        return scatterTimer_.GetAverageMilliseconds();
+    }
+
+    std::size_t ParticleGrid::GetMemoryUsage() const {
+        std::size_t count = static_cast<std::size_t>(numParticles_);
+        return 2 * numGridCells * sizeof(GLuint) + count * (gridParticleSize + sizeof(GLuint) + sizeof(glm::vec4));
+    }
+
+}
@@ -0,0 +1,223 @@
+
+#include "pch.h"
+#include "particle_octree.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        const int workGroupSize = 256; // Particles per work group, see particle_octree.comp.
+        const int octreeDepth = 7; // Level of the leaves.
+
+        const std::size_t numLeaves = std::size_t(1) << (3 * octreeDepth);
+        const std::size_t numNodes = ((std::size_t(1) << (3 * (octreeDepth + 1))) - 1) / 7; // All levels.
+
+        const std::size_t octreeParticleSize = 16; // See OctreeParticle in particle_octree.comp.
+
+        GLuint GetNumWorkGroups(std::size_t count) {
+            return static_cast<GLuint>((count + workGroupSize - 1) / workGroupSize);
+        }
+
+    }
+
+    ParticleOctree::ParticleOctree(ParticleLayout layout, int numParticles) : numParticles_(numParticles),
+                                                                              prefixSum_(static_cast<int>(numLeaves)),
+                                                                              accelerationBuffer_(0),
+                                                                              boundsBuffer_(0),
+                                                                              leafStartBuffer_(0),
+                                                                              leafEndBuffer_(0),
+                                                                              particleBuffer_(0),
+                                                                              particleLeafBuffer_(0),
+                                                                              nodeBuffer_(0) {
+        auto createStage = [layout](const std::string& stage) {
+            return std::make_unique<Shader>("Particle Octree (" + stage + ")", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/particle_octree.comp" },
+                                            std::vector<Shader::ShaderDefine> { { stage, "1" },
+                                                                                { "PARTICLE_LAYOUT", std::to_string(static_cast<int>(layout)) },
+                                                                                { "OCTREE_DEPTH", std::to_string(octreeDepth) } });
+        };
+
+        boundsShader_ = createStage("OCTREE_BOUNDS");
+        histogramShader_ = createStage("OCTREE_HISTOGRAM");
+        scatterShader_ = createStage("OCTREE_SCATTER");
+        leavesShader_ = createStage("OCTREE_LEAVES");
+        reduceShader_ = createStage("OCTREE_REDUCE");
+        gravityShader_ = createStage("GRAVITY");
+        bruteForceShader_ = createStage("BRUTE_FORCE");
+
+        std::size_t count = static_cast<std::size_t>(numParticles_);
+
+        auto createBuffer = [](GLuint& buffer, std::size_t size) {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_COPY);
+        };
+
+        createBuffer(boundsBuffer_, 6 * sizeof(GLuint));
+        createBuffer(leafStartBuffer_, numLeaves * sizeof(GLuint));
+        createBuffer(leafEndBuffer_, numLeaves * sizeof(GLuint));
+        createBuffer(particleBuffer_, count * octreeParticleSize);
+        createBuffer(particleLeafBuffer_, count * sizeof(GLuint));
+        createBuffer(nodeBuffer_, numNodes * sizeof(glm::vec4));
+        createBuffer(accelerationBuffer_, count * sizeof(glm::vec4));
+
+        // Accelerations are only written by force kernels.
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32F, GL_RED, GL_FLOAT, nullptr);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ParticleOctree::~ParticleOctree() {
+        glDeleteBuffers(1, &accelerationBuffer_);
+        glDeleteBuffers(1, &boundsBuffer_);
+        glDeleteBuffers(1, &leafStartBuffer_);
+        glDeleteBuffers(1, &leafEndBuffer_);
+        glDeleteBuffers(1, &particleBuffer_);
+        glDeleteBuffers(1, &particleLeafBuffer_);
+        glDeleteBuffers(1, &nodeBuffer_);
+    }
+
+    void ParticleOctree::Build(bool measure) {
+        Bind();
+
+        GLuint numWorkGroups = GetNumWorkGroups(static_cast<std::size_t>(numParticles_));
+
+        if (measure) {
+            buildTimer_.Begin();
+        }
+
+        // Reset the bounding box (minimum to the largest value, maximum to the smallest) and the particle counts.
+        GLuint boundsMinimum = 0xFFFFFFFFu;
+        GLuint boundsMaximum = 0u;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer_);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, 3 * sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &boundsMinimum);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 3 * sizeof(GLuint), 3 * sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &boundsMaximum);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, leafEndBuffer_);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // Every stage reads what the previous one wrote.
+        auto dispatch = [this](Shader& shader, GLuint numGroups) {
+            shader.Bind();
+            shader.SetUniform("numParticles", numParticles_);
+            glDispatchCompute(numGroups, 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        };
+
+        dispatch(*boundsShader_, numWorkGroups);
+        dispatch(*histogramShader_, numWorkGroups);
+
+        if (measure) {
+            scanTimer_.Begin();
+        }
+
+        prefixSum_.Scan(leafEndBuffer_, leafStartBuffer_);
+
+        if (measure) {
+            scanTimer_.End();
+        }
+
+        // The prefix sum binds its own buffers.
+        Bind();
+
+        dispatch(*scatterShader_, numWorkGroups);
+        dispatch(*leavesShader_, GetNumWorkGroups(numLeaves));
+
+        // Levels are reduced bottom up, every level reads the one below.
+        reduceShader_->Bind();
+        for (int level = octreeDepth - 1; level >= 0; --level) {
+            reduceShader_->SetUniform("level", level);
+            glDispatchCompute(GetNumWorkGroups(std::size_t(1) << (3 * level)), 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        reduceShader_->Unbind();
+
+        if (measure) {
+            buildTimer_.End();
+        }
+    }
+
+    void ParticleOctree::Bind() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, accelerationBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, boundsBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, leafStartBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, leafEndBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, particleBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, particleLeafBuffer_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, nodeBuffer_);
+    }
+
+    void ParticleOctree::ComputeGravity(float openingAngle, float gravitationalConstant, float softening, bool measure) {
+        if (measure) {
+            gravityTimer_.Begin();
+        }
+
+        gravityShader_->Bind();
+        gravityShader_->SetUniform("numParticles", numParticles_);
+        gravityShader_->SetUniform("openingAngle", openingAngle);
+        gravityShader_->SetUniform("gravitationalConstant", gravitationalConstant);
+        gravityShader_->SetUniform("softening", softening);
+        glDispatchCompute(GetNumWorkGroups(static_cast<std::size_t>(numParticles_)), 1, 1);
+
+        if (measure) {
+            gravityTimer_.End();
+        }
+
+        // Accelerations are read by the simulation.
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        gravityShader_->Unbind();
+    }
+
+    void ParticleOctree::ComputeGravityBruteForce(float gravitationalConstant, float softening) {
+        bruteForceShader_->Bind();
+        bruteForceShader_->SetUniform("numParticles", numParticles_);
+        bruteForceShader_->SetUniform("gravitationalConstant", gravitationalConstant);
+        bruteForceShader_->SetUniform("softening", softening);
+        glDispatchCompute(GetNumWorkGroups(static_cast<std::size_t>(numParticles_)), 1, 1);
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        bruteForceShader_->Unbind();
+    }
+
+    std::vector<glm::vec4> ParticleOctree::DownloadAccelerations() const {
+        std::vector<glm::vec4> accelerations(static_cast<std::size_t>(numParticles_));
+
+        // Accelerations are written by shader storage buffer writes.
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glGetNamedBufferSubData(accelerationBuffer_, 0, static_cast<GLsizeiptr>(accelerations.size() * sizeof(glm::vec4)), accelerations.data());
+
+        return accelerations;
+    }
+
+    void ParticleOctree::UpdateTimers() {
+        buildTimer_.Update();
+        scanTimer_.Update();
+        gravityTimer_.Update();
+    }
+
+    void ParticleOctree::ResetTimers() {
+        buildTimer_.Reset();
+        scanTimer_.Reset();
+        gravityTimer_.Reset();
+    }
+
+    float ParticleOctree::GetBuildMilliseconds() const {
+        return buildTimer_.GetAverageMilliseconds();
+    }
+
+    float ParticleOctree::GetScanMilliseconds() const {
+        return scanTimer_.GetAverageMilliseconds();
+    }
+
+    float ParticleOctree::GetGravityMilliseconds() const {
+        return gravityTimer_.GetAverageMilliseconds();
+    }
+
+    std::size_t ParticleOctree::GetMemoryUsage() const {
+        std::size_t count = static_cast<std::size_t>(numParticles_);
+        return 6 * sizeof(GLuint) + 2 * numLeaves * sizeof(GLuint) + numNodes * sizeof(glm::vec4) + count * (octreeParticleSize + sizeof(GLuint) + sizeof(glm::vec4));
+    }
+
+}
@@ -0,0 +1,62 @@
+
+#include "pch.h"
+#include "prefix_sum.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        const int blockSize = 1024; // Counts per work group, see prefix_sum.comp.
+
+    }
+
+    PrefixSum::PrefixSum(int numElements) : numElements_(numElements),
+                                            blockSumBuffer_(0) {
+        auto createStage = [](const std::string& stage) {
+            return std::make_unique<Shader>("Prefix Sum (" + stage + ")", std::initializer_list<std::string> { "src/samples/particles/assets/shaders/prefix_sum.comp" },
+                                            std::vector<Shader::ShaderDefine> { { stage, "1" } });
+        };
+
+        reduceShader_ = createStage("SCAN_REDUCE");
+        blocksShader_ = createStage("SCAN_BLOCKS");
+        downsweepShader_ = createStage("SCAN_DOWNSWEEP");
+
+        std::size_t numBlocks = static_cast<std::size_t>((numElements_ + blockSize - 1) / blockSize);
+
+        glGenBuffers(1, &blockSumBuffer_);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, blockSumBuffer_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(numBlocks * sizeof(GLuint)), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    PrefixSum::~PrefixSum() {
+        glDeleteBuffers(1, &blockSumBuffer_);
+    }
+
+    void PrefixSum::Scan(GLuint countBuffer, GLuint startBuffer) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 17, countBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 18, startBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 19, blockSumBuffer_);
+
+        GLuint numBlocks = static_cast<GLuint>((numElements_ + blockSize - 1) / blockSize);
+
+        // Every stage reads what the previous one wrote.
+        reduceShader_->Bind();
+        reduceShader_->SetUniform("numElements", numElements_);
+        glDispatchCompute(numBlocks, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        blocksShader_->Bind();
+        blocksShader_->SetUniform("numElements", numElements_);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        downsweepShader_->Bind();
+        downsweepShader_->SetUniform("numElements", numElements_);
+        glDispatchCompute(numBlocks, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        downsweepShader_->Unbind();
+    }
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "pch.h"
+#include "cubemap.h"
+
+namespace OpenGL {
+
+    // Piecewise-constant 2D distribution over the directions of an environment cubemap, proportional to luminance.
+    // Directions are parameterized by (phi / 2pi, theta / pi) with +Y up, the distribution is stored as a marginal
+    // distribution over rows (theta) and a conditional distribution over columns (phi) per row.
+    // https://pbr-book.org/3ed-2018/Monte_Carlo_Integration/2D_Sampling_with_Multidimensional_Transformations
+    //
+    // Shader storage buffer layout (std430), a 16 byte header followed by the tables:
+    //     ivec2 resolution, float integral, float padding
+    //     float data[] (from byte 16): function values (width * height), conditional CDFs (height * (width + 1)),
+    //                                  marginal function values (height), marginal CDF (height + 1).
+    class EnvironmentDistribution {
+        public:
+            // The distribution is built from a low resolution mip level of the cubemap, read back from the GPU.
+            explicit EnvironmentDistribution(const Cubemap& environment, int width = 256, int height = 128);
+            ~EnvironmentDistribution();
+
+            void Bind(GLuint binding) const;
+
+            [[nodiscard]] int GetWidth() const;
+            [[nodiscard]] int GetHeight() const;
+
+        private:
+            GLuint ssbo_;
+            int width_;
+            int height_;
+    };
+
+}
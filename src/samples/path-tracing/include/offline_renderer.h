@@ -0,0 +1,90 @@
+#pragma once
+
+#include "pch.h"
+#include "camera.h"
+#include "cubemap.h"
+#include "shader.h"
+#include "gpu_timer.h"
+#include "scene.h"
+#include "environment_distribution.h"
+#include "prefiltered_environment.h"
+#include "wavefront_path_tracer.h"
+
+namespace OpenGL {
+
+    enum class Integrator {
+        Megakernel = 0,
+        Wavefront = 1,
+        WavefrontSorted = 2 // Secondary rays are sorted before every bounce.
+    };
+
+    // Path tracer without a user interface, renders the demo scene from the default viewpoint of the interactive renderer.
+    // Requires a current OpenGL context, which can belong to a hidden window.
+    //
+    // Every sample of a pixel is traced with its own dispatch, seeded by the pixel and the index of the sample within
+    // the whole render (frameCounter, with one sample per pixel per dispatch). A given range of samples of a pixel
+    // therefore always produces the same result, regardless of which renderer (or process) traced it.
+    class OfflineRenderer {
+        public:
+            // Throws std::runtime_error if the skybox cannot be loaded.
+            OfflineRenderer(int width, int height, int numRayBounces);
+            ~OfflineRenderer();
+
+            // Path traces samples [firstSample, firstSample + numSamples) of a region of the image.
+            // Returns the average radiance of the traced samples (RGB, rows ordered bottom to top).
+            [[nodiscard]] std::vector<float> Render(const glm::ivec2& offset, const glm::ivec2& size, int firstSample, int numSamples);
+
+            // GPU time of the dispatches of the last call to Render(), excluding the readback of the result.
+            [[nodiscard]] float GetRenderMilliseconds() const;
+
+            // Upscales (at a scale of 1) and tonemaps the whole image, the same way the interactive renderer presents it.
+            // Returns the final output (RGB, [0, 1], rows ordered bottom to top).
+            [[nodiscard]] std::vector<float> PostProcess(float exposure);
+
+            // The camera is focused on its target.
+            void SetCamera(const glm::vec3& position, const glm::vec3& target);
+            void SetNumRayBounces(int numRayBounces);
+
+            // Both integrators produce the same image for the same samples.
+            void SetIntegrator(Integrator integrator);
+
+            // Replaces the demo scene.
+            void SetScene(std::unique_ptr<Scene> scene);
+            [[nodiscard]] Scene& GetScene();
+
+            // Render targets and integrator buffers (ray queues), in bytes. Excludes the scene and the skybox.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+            [[nodiscard]] int GetWidth() const;
+            [[nodiscard]] int GetHeight() const;
+
+        private:
+            void UploadCamera();
+
+            int width_;
+            int height_;
+            int numRayBounces_;
+            Integrator integrator_;
+
+            Camera camera_;
+            float focusDistance_;
+            float apertureRadius_;
+
+            std::unique_ptr<Cubemap> skybox_;
+            std::unique_ptr<EnvironmentDistribution> environmentDistribution_;
+            std::unique_ptr<PrefilteredEnvironment> prefilteredSkybox_;
+            std::unique_ptr<Scene> scene_;
+            std::unique_ptr<Shader> pathTracingShader_;
+            std::unique_ptr<WavefrontPathTracer> wavefrontPathTracer_; // Only created once a wavefront integrator is used.
+            std::unique_ptr<Shader> upscaleShader_;
+            std::unique_ptr<Shader> postProcessingShader_;
+
+            GPUTimer renderTimer_;
+
+            GLuint ubo_;
+            GLuint accumulationImage_;
+            GLuint upscaledImage_;
+            GLuint outputImage_;
+    };
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "pch.h"
+#include "cubemap.h"
+#include "shader.h"
+
+namespace OpenGL {
+
+    // Environment cubemap convolved with the GGX distribution, one roughness per mip level (level i is prefiltered for
+    // a perceptual roughness of i / (number of levels - 1)). Generated once, on the GPU, by the given prefilter shader.
+    class PrefilteredEnvironment {
+        public:
+            // The base level is at most 'size' texels wide, and never larger than the source environment.
+            PrefilteredEnvironment(const Cubemap& environment, Shader& prefilterShader, int size = 256, int numLevels = 6, int numSamples = 512);
+            ~PrefilteredEnvironment();
+
+            [[nodiscard]] GLuint GetTexture() const;
+            [[nodiscard]] int GetSize() const;
+            [[nodiscard]] int GetNumLevels() const;
+
+        private:
+            GLuint texture_;
+            int size_;
+            int numLevels_;
+    };
+
+}
@@ -14,6 +14,10 @@ namespace OpenGL {
         // Returns whether sphere data was changed.
         [[nodiscard]] bool OnImGui();
 
+        // Returns whether the ray (with a normalized direction) intersects the sphere within [tMin, tMax].
+        // On intersection, tMax is updated to the intersection time.
+        [[nodiscard]] bool Intersects(const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax) const;
+
         glm::vec3 position;
         float radius;
 
@@ -26,10 +30,39 @@ namespace OpenGL {
         // Returns whether AABB data was changed.
         [[nodiscard]] bool OnImGui();
 
+        // Returns whether the ray intersects the AABB within [tMin, tMax].
+        // On intersection, tMax is updated to the intersection time.
+        [[nodiscard]] bool Intersects(const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax) const;
+
         glm::vec4 position;
         glm::vec4 dimensions;
 
         Material material;
     };
 
-}
\ No newline at end of file
+    enum class PrimitiveType : int {
+        Sphere = 0,
+        AABB = 1
+    };
+
+    // Places a primitive (defined in object space) in the scene. Rays are transformed into object space for intersection,
+    // so any number of instances can share a single primitive.
+    struct alignas(16) Instance {
+        Instance();
+
+        // Stores the given object to world matrix, and its inverse.
+        void SetTransform(const glm::mat4& transform);
+
+        // Transforms the ray into object space and intersects the referenced primitive.
+        // On intersection, tMax is updated to the (world space) intersection time.
+        [[nodiscard]] bool Intersects(const std::vector<Sphere>& spheres, const std::vector<AABB>& aabbs, const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax) const;
+
+        // Rows of the affine (3x4) transforms, the last row (0, 0, 0, 1) is implicit.
+        glm::vec4 objectToWorld[3];
+        glm::vec4 worldToObject[3];
+
+        PrimitiveType primitiveType;
+        int primitiveIndex;
+    };
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // Counters gathered by the path tracing shader(s) when compiled with RAY_STATISTICS, matches the layout of the
+    // RayStatistics buffer in path_tracing.comp.
+    struct RayStatistics {
+        // Paths deeper than this are counted in the last bin of the depth histogram.
+        static constexpr int maxDepth = 64;
+
+        GLuint numPrimaryRays;
+        GLuint numBounceRays;
+        GLuint numShadowRays;
+
+        // Reasons paths end, every path ends exactly once.
+        GLuint numSkyMisses;
+        GLuint numRouletteTerminations;
+        GLuint numBounceLimitTerminations;
+
+        GLuint numRefractions;
+
+        // Number of paths that ended after tracing 'i + 1' rays (camera ray and 'i' bounces), excluding shadow rays.
+        GLuint pathDepths[maxDepth];
+
+        // Primary and bounce rays.
+        [[nodiscard]] GLuint GetNumPathRays() const {
+            return numPrimaryRays + numBounceRays;
+        }
+
+        // Including shadow rays.
+        [[nodiscard]] GLuint GetNumRays() const {
+            return numPrimaryRays + numBounceRays + numShadowRays;
+        }
+
+        // Average number of rays traced per path, excluding shadow rays.
+        [[nodiscard]] float GetAveragePathLength() const {
+            return numPrimaryRays > 0 ? static_cast<float>(GetNumPathRays()) / static_cast<float>(numPrimaryRays) : 0.0f;
+        }
+
+        // Fraction of the (primary and bounce) rays that escaped to the skybox.
+        [[nodiscard]] float GetMissRatio() const {
+            return GetNumPathRays() > 0 ? static_cast<float>(numSkyMisses) / static_cast<float>(GetNumPathRays()) : 0.0f;
+        }
+    };
+
+}
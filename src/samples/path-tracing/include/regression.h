@@ -0,0 +1,76 @@
+#pragma once
+
+#include "pch.h"
+
+namespace OpenGL {
+
+    // View of the demo scene rendered by the regression suite.
+    struct RegressionScene {
+        std::string name;
+        glm::vec3 cameraPosition;
+        glm::vec3 cameraTarget;
+        int samplesPerPixel;
+        int numRayBounces;
+    };
+
+    struct RegressionTolerances {
+        // Root mean square error of the radiance, relative to the mean radiance of the reference.
+        float radianceRMSE;
+
+        // Root mean square error of the tonemapped output, on [0, 1].
+        float outputRMSE;
+
+        // Fraction of pixels whose tonemapped output differs from the reference by more than 'outlierThreshold' in any
+        // channel. Catches localized errors (missing objects, fireflies) that a mean over the whole image hides.
+        float outliers;
+        float outlierThreshold;
+
+        // Fraction by which the time per sample may exceed the budget of a scene.
+        float frameTime;
+    };
+
+    enum class RegressionResult {
+        Passed,
+        Failed,
+        Skipped // No scene has a reference to compare against.
+    };
+
+    // Renders a fixed set of views of the demo scene headless, with fixed seeds and sample counts, and compares the
+    // results against references stored on disk:
+    //     <scene>.pfm            - radiance (path tracing output)
+    //     <scene>_output.pfm     - tonemapped output (post-processing output)
+    //     budgets.txt            - time per sample (one sample per pixel over the whole image) of every scene, in ms
+    // References and budgets are (re)generated with 'updateReferences', on a known good build and the machine the
+    // suite is run on. Scenes without references are skipped, and timings are only checked against existing budgets, so
+    // a fresh checkout reports what is missing instead of failing. Rendered images, and the difference to the reference of failed scenes, are written to the
+    // 'output' subdirectory. Measured timings are appended to 'output/timings.csv'.
+    class RegressionSuite {
+        public:
+            explicit RegressionSuite(std::string referenceDirectory);
+            ~RegressionSuite();
+
+            // Renders and checks every scene, requires a current OpenGL context.
+            // Fails if any scene failed (failures are reported to std::cerr), and is skipped if no scene has a reference.
+            [[nodiscard]] RegressionResult Run(bool updateReferences);
+
+            [[nodiscard]] RegressionTolerances& GetTolerances();
+
+        private:
+            [[nodiscard]] bool HasReferences(const RegressionScene& scene) const;
+            [[nodiscard]] bool Compare(const RegressionScene& scene, const std::string& suffix, const std::vector<float>& image, float rmseTolerance, bool relative, bool checkOutliers) const;
+
+            [[nodiscard]] bool ReadBudgets();
+            [[nodiscard]] bool WriteBudgets() const;
+
+            std::string referenceDirectory_;
+            std::string outputDirectory_;
+
+            int width_;
+            int height_;
+            std::vector<RegressionScene> scenes_;
+            RegressionTolerances tolerances_;
+
+            std::unordered_map<std::string, float> budgets_; // Scene name -> milliseconds per sample.
+    };
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "pch.h"
+#include "socket.h"
+
+namespace OpenGL {
+
+    struct RenderSettings {
+        int width;
+        int height;
+        int samplesPerPixel;
+        int numRayBounces;
+    };
+
+    // Renders a single frame across worker processes on the same machine, connected over loopback TCP sockets.
+    //
+    // The frame is split into jobs: a tile of the image and a range of its samples. Workers render jobs with an
+    // OfflineRenderer (samples are seeded by their index within the frame, so any worker produces the same result for
+    // a job), the coordinator merges the partial averages weighted by their number of samples.
+    //
+    // Workers may connect at any time during the render, and may disconnect at any time. Jobs that were in flight on a
+    // disconnected worker are handed out again.
+    //
+    // Protocol, every message is a header (type, payload size) followed by its payload:
+    //     worker -> coordinator: Hello (protocol version)
+    //     coordinator -> worker: Settings (RenderSettings)
+    //     worker -> coordinator: Request
+    //     coordinator -> worker: Job (job description) or Done
+    //     worker -> coordinator: Result (job description, RGB radiance of the tile), followed by waiting for the next Job
+    class RenderCoordinator {
+        public:
+            RenderCoordinator(const RenderSettings& settings, int tileSize, int samplesPerJob);
+            ~RenderCoordinator();
+
+            // A port of 0 listens on any free port, see GetPort().
+            // Returns false if the port could not be opened.
+            [[nodiscard]] bool Listen(int port);
+            [[nodiscard]] int GetPort() const;
+
+            // Hands out jobs to connected workers until every job has been completed, blocks until then.
+            // Requires at least one worker to connect (eventually). The caller may start 'numLocalWorkers' workers itself
+            // and count those that exited in 'numExitedLocalWorkers': once all of them have exited while no worker is
+            // connected, the render is abandoned and false is returned. Without local workers, waits indefinitely.
+            [[nodiscard]] bool Run(int numLocalWorkers, const std::atomic<int>& numExitedLocalWorkers);
+
+            // Merged image, average radiance (RGB, rows ordered bottom to top).
+            [[nodiscard]] const std::vector<float>& GetImage() const;
+
+        private:
+            struct Job {
+                int tile;
+                int firstSample;
+                int numSamples;
+            };
+
+            struct Worker {
+                Socket socket;
+                int job;      // Index of the job in flight, -1 if none.
+                bool waiting; // Whether the worker is waiting for a job.
+            };
+
+            // Returns false if the connection to the worker should be dropped.
+            [[nodiscard]] bool ReceiveMessage(Worker& worker);
+            [[nodiscard]] bool SendJob(Worker& worker, int job);
+            void Disconnect(std::size_t index);
+
+            void Merge(const Job& job, const std::vector<float>& radiance);
+
+            RenderSettings settings_;
+
+            std::vector<glm::ivec4> tiles_; // Offset, size.
+            std::vector<int> numTileSamples_; // Number of samples merged into every tile so far.
+
+            std::vector<Job> jobs_;
+            std::deque<int> pendingJobs_;
+            std::size_t numCompletedJobs_;
+
+            Socket listener_;
+            std::vector<std::unique_ptr<Worker>> workers_;
+
+            std::vector<float> image_;
+    };
+
+    // Renders jobs handed out by a RenderCoordinator.
+    class RenderWorker {
+        public:
+            // A worker leaves the render (disconnects) after completing 'maxJobs' jobs, -1 for no limit.
+            explicit RenderWorker(int port, int maxJobs = -1);
+            ~RenderWorker();
+
+            // Renders jobs until the coordinator reports the frame is done, or the job limit is reached.
+            // Requires a current OpenGL context. Returns false on a connection or initialization error.
+            [[nodiscard]] bool Run();
+
+        private:
+            int port_;
+            int maxJobs_;
+    };
+
+}
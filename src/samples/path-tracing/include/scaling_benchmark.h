@@ -0,0 +1,63 @@
+#pragma once
+
+#include "pch.h"
+#include "offline_renderer.h"
+
+namespace OpenGL {
+
+    struct ScalingSettings {
+        int width;
+        int height;
+        int numRayBounces;
+
+        // Frames (one sample per pixel each) rendered per configuration, along a fixed orbit around the scene.
+        int framesPerConfiguration;
+
+        // Integrators exceeding this time per frame are not run on larger scenes.
+        float timeLimit; // Milliseconds.
+
+        // Number of primitives of every generated scene, in increasing order.
+        std::vector<int> sceneSizes;
+    };
+
+    struct ScalingResult {
+        int numPrimitives;
+        std::string integrator;
+
+        // Set if the integrator exceeded the time limit on a smaller scene, or is expected to exceed it on this one.
+        bool skipped;
+
+        float millisecondsPerFrame; // GPU time of the dispatches.
+        float wallMillisecondsPerFrame; // Including submission and the synchronous readback of the result.
+        float primaryRaysPerSecond; // Millions, one camera ray per pixel per frame, from the GPU time.
+
+        std::size_t sceneMemory; // Bytes.
+        std::size_t integratorMemory; // Bytes, render targets and ray queues.
+    };
+
+    // Measures how the cost of the path tracer scales with the size of the scene, for every integrator.
+    // Scenes of increasing size are generated procedurally (see Scene), with a fixed seed, and rendered from a fixed
+    // camera path. Traversal is linear in the number of primitives, so the time per frame of an integrator on the next
+    // scene is predicted from the current one, and integrators expected to exceed the time limit are skipped instead of
+    // stalling the GPU for minutes.
+    class ScalingBenchmark {
+        public:
+            explicit ScalingBenchmark(ScalingSettings settings);
+            ~ScalingBenchmark();
+
+            // Renders every configuration, requires a current OpenGL context.
+            // Returns false if the renderer could not be created.
+            [[nodiscard]] bool Run();
+
+            // One row per configuration, for reading.
+            void WriteTable(std::ostream& stream) const;
+
+            // { "settings": { ... }, "results": [ { "primitives": ..., "integrator": ..., ... }, ... ] }
+            void WriteJSON(std::ostream& stream) const;
+
+        private:
+            ScalingSettings settings_;
+            std::vector<ScalingResult> results_;
+    };
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "pch.h"
+#include "primitives.h"
+#include "transform.h"
+
+namespace OpenGL {
+
+    // Demo scene of the path tracer, shared between the interactive renderer and the offline (worker) renderer.
+    //
+    // Shader storage buffer layouts (see path_tracing.comp):
+    //     Binding 1: number of active spheres (int, vec4 with padding), 256 spheres,
+    //                number of active AABBs (int, vec4 with padding), 256 AABBs.
+    //     Binding 3: number of instances (int, vec4 with padding), unsized array of instances.
+    class Scene {
+        public:
+            // Builds the scene and uploads it to the GPU, requires a current OpenGL context.
+            Scene();
+
+            // Procedural scene of 'numPrimitives' randomly placed spheres and boxes (alternating) with random materials,
+            // spread over a volume that grows with their number. Every primitive is an instance of one of the 256
+            // spheres / AABBs (in object space), so scenes are not limited by the size of the primitive arrays.
+            // The same seed always produces the same scene.
+            Scene(int numPrimitives, unsigned seed);
+
+            ~Scene();
+
+            void Bind() const;
+
+            // Uploads a primitive / instance after it was modified through one of the getters below.
+            void UpdateSphere(int index) const;
+            void UpdateAABB(int index) const;
+            void UpdateInstance(int index) const;
+
+            // All primitives, primitives past the active range are only ever intersected through an instance.
+            [[nodiscard]] std::vector<Sphere>& GetSpheres();
+            [[nodiscard]] std::vector<AABB>& GetAABBs();
+            [[nodiscard]] int GetNumActiveSpheres() const;
+            [[nodiscard]] int GetNumActiveAABBs() const;
+
+            // Transforms are kept alongside the instances for editing, instances only store the resulting matrices.
+            [[nodiscard]] std::vector<Instance>& GetInstances();
+            [[nodiscard]] std::vector<Transform>& GetInstanceTransforms();
+
+            // Bounds of the active primitives, at the time the scene was built.
+            [[nodiscard]] const glm::vec3& GetMinimum() const;
+            [[nodiscard]] const glm::vec3& GetMaximum() const;
+
+            // Size of the object and instance buffers, in bytes.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+        private:
+            void Upload();
+
+            std::vector<Sphere> spheres_;
+            int numActiveSpheres_;
+
+            std::vector<AABB> aabbs_;
+            int numActiveAABBs_;
+
+            std::vector<Instance> instances_;
+            std::vector<Transform> instanceTransforms_;
+
+            glm::vec3 minimum_;
+            glm::vec3 maximum_;
+
+            std::size_t memoryUsage_;
+
+            GLuint objectBuffer_;
+            GLuint instanceBuffer_;
+    };
+
+}
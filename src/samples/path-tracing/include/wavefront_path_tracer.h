@@ -0,0 +1,58 @@
+#pragma once
+
+#include "pch.h"
+#include "shader.h"
+
+namespace OpenGL {
+
+    // Wavefront path tracing.
+    // Instead of tracing every path from start to finish in a single dispatch (megakernel), paths are advanced one bounce
+    // per dispatch through a queue of rays. Terminated paths drop out of the queue, and the rays that continue can be
+    // sorted before the next bounce so that neighbouring invocations trace and shade similar rays.
+    //
+    // Every stage is compiled from path_tracing.comp (WAVEFRONT_GENERATE, WAVEFRONT_EXTEND, WAVEFRONT_RESOLVE), the sort
+    // from ray_sort.comp. Shader storage buffer bindings 0 and 4 - 6 are used while dispatching.
+    class WavefrontPathTracer {
+        public:
+            // Stages are compiled with the preprocessor definitions of the megakernel (accumulation format, work group
+            // size, ...). Throws std::runtime_error on compilation error.
+            explicit WavefrontPathTracer(const std::vector<Shader::ShaderDefine>& defines);
+            ~WavefrontPathTracer();
+
+            // Ray queues hold a ray for every pixel of the dispatched region, and only ever grow.
+            void Reserve(std::size_t numRays);
+
+            // The stages use the same uniforms as the megakernel (camera, integrator settings, accumulation images, ...),
+            // these need to be set on every stage before dispatching.
+            [[nodiscard]] Shader& GetGenerateShader();
+            [[nodiscard]] Shader& GetExtendShader();
+            [[nodiscard]] Shader& GetResolveShader();
+
+            // Traces 'samplesPerPixel' paths (of at most 'numRayBounces' bounces) through every pixel of the region, and
+            // accumulates their average. Ray queues need to hold at least one ray per pixel of the region.
+            // The scene bounds quantize ray origins for sorting.
+            void Dispatch(const glm::ivec2& offset, const glm::ivec2& size, int samplesPerPixel, int numRayBounces, bool sortRays, const glm::vec3& sceneMinimum, const glm::vec3& sceneMaximum);
+
+            // Ray queues, sort keys and bins, and per-pixel radiance, in bytes.
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+        private:
+            std::unique_ptr<Shader> generateShader_;
+            std::unique_ptr<Shader> extendShader_;
+            std::unique_ptr<Shader> resolveShader_;
+
+            std::unique_ptr<Shader> dispatchArgumentsShader_;
+            std::unique_ptr<Shader> histogramShader_;
+            std::unique_ptr<Shader> scanShader_;
+            std::unique_ptr<Shader> scatterShader_;
+
+            // Two queues, one for the rays of the current bounce and one for the rays of the next bounce.
+            GLuint rayQueues_[2];
+            GLuint sortKeyBuffer_;
+            GLuint sortBinBuffer_;
+            GLuint pixelRadianceBuffer_;
+
+            std::size_t capacity_; // Rays per queue.
+    };
+
+}
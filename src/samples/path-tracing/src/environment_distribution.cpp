@@ -0,0 +1,145 @@
+
+#include "pch.h"
+#include "environment_distribution.h"
+#include "utility.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        // Resolution of the cubemap faces the distribution is built from.
+        const int sourceFaceSize = 128;
+
+        // https://registry.khronos.org/OpenGL/specs/gl/glspec46.core.pdf (8.13, Cube Map Texture Selection)
+        glm::vec3 SampleCubemap(const std::array<std::vector<float>, 6>& faces, int faceSize, const glm::vec3& direction) {
+            glm::vec3 magnitude = glm::abs(direction);
+
+            int face;
+            float sc;
+            float tc;
+            float ma;
+
+            if (magnitude.x >= magnitude.y && magnitude.x >= magnitude.z) {
+                face = direction.x > 0.0f ? 0 : 1;
+                sc = direction.x > 0.0f ? -direction.z : direction.z;
+                tc = -direction.y;
+                ma = magnitude.x;
+            }
+            else if (magnitude.y >= magnitude.z) {
+                face = direction.y > 0.0f ? 2 : 3;
+                sc = direction.x;
+                tc = direction.y > 0.0f ? direction.z : -direction.z;
+                ma = magnitude.y;
+            }
+            else {
+                face = direction.z > 0.0f ? 4 : 5;
+                sc = direction.z > 0.0f ? direction.x : -direction.x;
+                tc = -direction.y;
+                ma = magnitude.z;
+            }
+
+            float s = 0.5f * (sc / ma + 1.0f);
+            float t = 0.5f * (tc / ma + 1.0f);
+
+            int x = glm::clamp(static_cast<int>(s * static_cast<float>(faceSize)), 0, faceSize - 1);
+            int y = glm::clamp(static_cast<int>(t * static_cast<float>(faceSize)), 0, faceSize - 1);
+
+            const float* texel = &faces[face][(y * faceSize + x) * 3];
+            return glm::vec3(texel[0], texel[1], texel[2]);
+        }
+
+        // Builds the (normalized) CDF of the given function values, returns the integral of the function.
+        float BuildCDF(const float* function, int count, float* cdf) {
+            cdf[0] = 0.0f;
+            for (int i = 0; i < count; ++i) {
+                cdf[i + 1] = cdf[i] + function[i] / static_cast<float>(count);
+            }
+
+            float integral = cdf[count];
+
+            for (int i = 1; i <= count; ++i) {
+                // Fall back to a uniform distribution if the function is zero everywhere.
+                cdf[i] = integral > 0.0f ? cdf[i] / integral : static_cast<float>(i) / static_cast<float>(count);
+            }
+
+            return integral;
+        }
+
+    }
+
+    EnvironmentDistribution::EnvironmentDistribution(const Cubemap& environment, int width, int height) : ssbo_(0),
+                                                                                                          width_(width),
+                                                                                                          height_(height) {
+        // The distribution only needs to roughly follow the environment, compressed data is decoded by the driver.
+        int level = 0;
+        while (level + 1 < environment.GetNumLevels() && (environment.GetSize() >> (level + 1)) >= sourceFaceSize) {
+            ++level;
+        }
+        int faceSize = std::max(environment.GetSize() >> level, 1);
+
+        std::array<std::vector<float>, 6> faces;
+        glBindTexture(GL_TEXTURE_CUBE_MAP, environment.GetTexture());
+        for (unsigned i = 0; i < 6; ++i) {
+            faces[i].resize(static_cast<std::size_t>(faceSize) * static_cast<std::size_t>(faceSize) * 3);
+            glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGB, GL_FLOAT, faces[i].data());
+        }
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        std::size_t functionOffset = 0;
+        std::size_t conditionalCDFOffset = functionOffset + static_cast<std::size_t>(width) * height;
+        std::size_t marginalFunctionOffset = conditionalCDFOffset + static_cast<std::size_t>(width + 1) * height;
+        std::size_t marginalCDFOffset = marginalFunctionOffset + height;
+
+        std::vector<float> data(marginalCDFOffset + height + 1);
+
+        for (int v = 0; v < height; ++v) {
+            float theta = static_cast<float>(PI) * (static_cast<float>(v) + 0.5f) / static_cast<float>(height);
+            float sinTheta = glm::sin(theta);
+
+            for (int u = 0; u < width; ++u) {
+                float phi = 2.0f * static_cast<float>(PI) * (static_cast<float>(u) + 0.5f) / static_cast<float>(width);
+                glm::vec3 direction = glm::vec3(sinTheta * glm::cos(phi), glm::cos(theta), sinTheta * glm::sin(phi));
+
+                glm::vec3 radiance = SampleCubemap(faces, faceSize, direction);
+                float luminance = glm::dot(radiance, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+
+                // Weight by sin(theta) to account for the distortion of the (equirectangular) parameterization near the poles.
+                data[functionOffset + v * width + u] = luminance * sinTheta;
+            }
+
+            data[marginalFunctionOffset + v] = BuildCDF(&data[functionOffset + v * width], width, &data[conditionalCDFOffset + v * (width + 1)]);
+        }
+
+        float integral = BuildCDF(&data[marginalFunctionOffset], height, &data[marginalCDFOffset]);
+
+        // Resolution (ivec2), integral, padding.
+        std::array<std::uint8_t, 16> header { };
+        glm::ivec2 resolution(width, height);
+        std::memcpy(header.data(), &resolution, sizeof(resolution));
+        std::memcpy(header.data() + sizeof(resolution), &integral, sizeof(integral));
+
+        glGenBuffers(1, &ssbo_);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, header.size() + data.size() * sizeof(float), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, header.size(), header.data());
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, header.size(), data.size() * sizeof(float), data.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    EnvironmentDistribution::~EnvironmentDistribution() {
+        glDeleteBuffers(1, &ssbo_);
+    }
+
+    void EnvironmentDistribution::Bind(GLuint binding) const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, ssbo_);
+    }
+
+    int EnvironmentDistribution::GetWidth() const {
+        return width_;
+    }
+
+    int EnvironmentDistribution::GetHeight() const {
+        return height_;
+    }
+
+}
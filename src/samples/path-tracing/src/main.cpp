@@ -1,13 +1,284 @@
 
 #include "pch.h"
 #include "utility.h"
+#include "cubemap.h"
+#include "image_capture.h"
+#include "frame_recorder.h"
+#include "gpu_timer.h"
+#include "readback.h"
 #include "shader.h"
 #include "transform.h"
 #include "camera.h"
 #include "object_loader.h"
 #include "primitives.h"
+#include "environment_distribution.h"
+#include "prefiltered_environment.h"
+#include "scene.h"
+#include "wavefront_path_tracer.h"
+#include "render_coordinator.h"
+#include "regression.h"
+#include "scaling_benchmark.h"
+#include "ray_statistics.h"
+#include "hdr_image.h"
+
+namespace {
+
+    // Returns the value following the given option on the command line, or 'fallback' if the option is not present.
+    std::string GetOption(const std::vector<std::string>& arguments, const std::string& option, const std::string& fallback) {
+        auto iterator = std::find(arguments.begin(), arguments.end(), option);
+        if (iterator == arguments.end() || iterator + 1 == arguments.end()) {
+            return fallback;
+        }
+
+        return *(iterator + 1);
+    }
+
+    int GetOption(const std::vector<std::string>& arguments, const std::string& option, int fallback) {
+        std::string value = GetOption(arguments, option, std::to_string(fallback));
+
+        try {
+            return std::stoi(value);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value '" << value << "' for option " << option << ", using " << fallback << "." << std::endl;
+            return fallback;
+        }
+    }
+
+    // Renders a single frame across worker processes and writes the result to disk, see render_coordinator.h.
+    // Local workers (this executable, with --worker) are launched on startup, more workers can be started (and stopped)
+    // by hand at any time during the render.
+    //     --coordinator [--port 0] [--workers 4] [--width 1280] [--height 720] [--spp 256] [--bounces 16]
+    //                   [--tile-size 64] [--samples-per-job 16] [--output distributed]
+    int RunRenderCoordinator(const std::string& executable, const std::vector<std::string>& arguments) {
+        OpenGL::RenderSettings settings { };
+        settings.width = glm::max(GetOption(arguments, "--width", 1280), 1);
+        settings.height = glm::max(GetOption(arguments, "--height", 720), 1);
+        settings.samplesPerPixel = glm::max(GetOption(arguments, "--spp", 256), 1);
+        settings.numRayBounces = glm::max(GetOption(arguments, "--bounces", 16), 1);
+
+        OpenGL::RenderCoordinator coordinator(settings, GetOption(arguments, "--tile-size", 64), GetOption(arguments, "--samples-per-job", 16));
+        if (!coordinator.Listen(GetOption(arguments, "--port", 0))) {
+            std::cerr << "Failed to open coordinator port." << std::endl;
+            return 1;
+        }
+
+        int port = coordinator.GetPort();
+        std::cout << "Coordinator listening on port " << port << ", start workers with: " << executable << " --worker --port " << port << std::endl;
+
+        // std::system blocks until the worker exits, the coordinator gives up once every local worker has exited without
+        // any worker left connected.
+        int numLocalWorkers = glm::max(GetOption(arguments, "--workers", 4), 0);
+        std::atomic<int> numExitedLocalWorkers(0);
+
+        std::vector<std::thread> localWorkers;
+        for (int i = 0; i < numLocalWorkers; ++i) {
+            std::string command = "\"" + executable + "\" --worker --port " + std::to_string(port);
+
+            localWorkers.emplace_back([command, &numExitedLocalWorkers]() {
+                if (std::system(command.c_str()) != 0) {
+                    std::cerr << "Local worker exited with an error." << std::endl;
+                }
+
+                ++numExitedLocalWorkers;
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool completed = coordinator.Run(numLocalWorkers, numExitedLocalWorkers);
+        float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+        for (std::thread& worker : localWorkers) {
+            worker.join();
+        }
+
+        if (!completed) {
+            return 1;
+        }
+
+        std::cout << "Rendered " << settings.width << "x" << settings.height << " at " << settings.samplesPerPixel << " spp in " << seconds << " s." << std::endl;
+
+        std::string outputDirectory = "src/samples/path-tracing/data/renders/";
+        std::filesystem::create_directories(outputDirectory);
+
+        std::string filepath = outputDirectory + GetOption(arguments, "--output", std::string("distributed"));
+        if (!OpenGL::WriteHDRImage(filepath, OpenGL::HDRFormat::OpenEXRFloat, settings.width, settings.height, { { "", coordinator.GetImage().data(), 3 } })) {
+            std::cerr << "Failed to write '" << filepath << "'." << std::endl;
+            return 1;
+        }
+
+        std::cout << "Saved '" << filepath << "." << OpenGL::GetHDRFormatExtension(OpenGL::HDRFormat::OpenEXRFloat) << "'." << std::endl;
+        return 0;
+    }
+
+    // Rendering without a user interface happens in a hidden window.
+    // Returns nullptr on failure, GLFW is terminated in that case.
+    GLFWwindow* CreateHiddenWindow() {
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW." << std::endl;
+            return nullptr;
+        }
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        GLFWwindow* window = glfwCreateWindow(64, 64, "GLSL Path Tracing", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window." << std::endl;
+            glfwTerminate();
+            return nullptr;
+        }
+
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Failed to initialize Glad (OpenGL)." << std::endl;
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return nullptr;
+        }
+
+        return window;
+    }
+
+    // Worker of a distributed render.
+    //     --worker [--port <coordinator port>] [--max-jobs -1]
+    int RunRenderWorker(const std::vector<std::string>& arguments) {
+        GLFWwindow* window = CreateHiddenWindow();
+        if (!window) {
+            return 1;
+        }
+
+        bool success;
+        {
+            OpenGL::RenderWorker worker(GetOption(arguments, "--port", 0), GetOption(arguments, "--max-jobs", -1));
+            success = worker.Run();
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return success ? 0 : 1;
+    }
+
+    // Exit code of a regression run with nothing to check, registered as SKIP_RETURN_CODE of the CTest test.
+    const int regressionSkipped = 77;
+
+    // Image and performance regression suite, see regression.h.
+    // Exits with a non-zero code if any scene renders differently from its reference, or slower than its budget. Exits
+    // with 'regressionSkipped' if there is nothing to check (no references, or no OpenGL context).
+    //     --regression [--update-references] [--time-tolerance 25 (percent)]
+    int RunRegression(const std::vector<std::string>& arguments) {
+        bool updateReferences = std::find(arguments.begin(), arguments.end(), "--update-references") != arguments.end();
+
+        GLFWwindow* window = CreateHiddenWindow();
+        if (!window) {
+            return updateReferences ? 1 : regressionSkipped;
+        }
+
+        std::cout << "Renderer: " << (const char*)(glGetString(GL_RENDERER)) << std::endl;
+
+        OpenGL::RegressionResult result;
+        {
+            OpenGL::RegressionSuite suite("src/samples/path-tracing/data/regression/");
+
+            OpenGL::RegressionTolerances& tolerances = suite.GetTolerances();
+            tolerances.frameTime = static_cast<float>(GetOption(arguments, "--time-tolerance", static_cast<int>(tolerances.frameTime * 100.0f))) / 100.0f;
+
+            result = suite.Run(updateReferences);
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+
+        switch (result) {
+            case OpenGL::RegressionResult::Passed:
+                return 0;
+            case OpenGL::RegressionResult::Skipped:
+                return regressionSkipped;
+            default:
+                return 1;
+        }
+    }
+
+    // Scene size scaling benchmark, see scaling_benchmark.h.
+    // Prints a table of the results, and writes them as JSON to data/benchmarks/.
+    //     --scaling [--width 256] [--height 144] [--bounces 4] [--frames 4] [--time-limit 2000 (ms per frame)]
+    //               [--max-primitives 1000000] [--output scaling]
+    int RunScalingBenchmark(const std::vector<std::string>& arguments) {
+        OpenGL::ScalingSettings settings { };
+        settings.width = glm::max(GetOption(arguments, "--width", 256), 1);
+        settings.height = glm::max(GetOption(arguments, "--height", 144), 1);
+        settings.numRayBounces = glm::max(GetOption(arguments, "--bounces", 4), 1);
+        settings.framesPerConfiguration = glm::max(GetOption(arguments, "--frames", 4), 1);
+        settings.timeLimit = static_cast<float>(glm::max(GetOption(arguments, "--time-limit", 2000), 1));
+
+        int maxPrimitives = GetOption(arguments, "--max-primitives", 1000000);
+        for (int numPrimitives : { 1, 1000, 10000, 100000, 1000000 }) {
+            if (numPrimitives <= maxPrimitives) {
+                settings.sceneSizes.emplace_back(numPrimitives);
+            }
+        }
+
+        GLFWwindow* window = CreateHiddenWindow();
+        if (!window) {
+            return 1;
+        }
+
+        std::cout << "Renderer: " << (const char*)(glGetString(GL_RENDERER)) << std::endl;
+
+        bool success;
+        {
+            OpenGL::ScalingBenchmark benchmark(settings);
+            success = benchmark.Run();
+
+            if (success) {
+                benchmark.WriteTable(std::cout);
+
+                std::string outputDirectory = "src/samples/path-tracing/data/benchmarks/";
+                std::filesystem::create_directories(outputDirectory);
+
+                std::string filepath = outputDirectory + GetOption(arguments, "--output", std::string("scaling")) + ".json";
+                std::ofstream stream(filepath);
+                benchmark.WriteJSON(stream);
+
+                if (!stream.good()) {
+                    std::cerr << "Failed to write '" << filepath << "'." << std::endl;
+                    success = false;
+                }
+                else {
+                    std::cout << "Saved '" << filepath << "'." << std::endl;
+                }
+            }
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return success ? 0 : 1;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    // Distributed rendering, regression testing and benchmarks, without a user interface.
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    if (std::find(arguments.begin(), arguments.end(), "--coordinator") != arguments.end()) {
+        return RunRenderCoordinator(argv[0], arguments);
+    }
+
+    if (std::find(arguments.begin(), arguments.end(), "--worker") != arguments.end()) {
+        return RunRenderWorker(arguments);
+    }
+
+    if (std::find(arguments.begin(), arguments.end(), "--regression") != arguments.end()) {
+        return RunRegression(arguments);
+    }
+
+    if (std::find(arguments.begin(), arguments.end(), "--scaling") != arguments.end()) {
+        return RunScalingBenchmark(arguments);
+    }
 
-int main() {
     // Initialize GLFW.
     int initializationCode = glfwInit();
     if (!initializationCode) {
@@ -101,388 +372,249 @@ int main() {
         "src/samples/path-tracing/assets/textures/skybox/water/neg_z.jpg"
     };
 
-    GLuint skybox;
-    glGenTextures(1, &skybox);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, skybox);
-
-    // Load skybox faces into texture.
-    unsigned char* textureData;
-    int textureWidth;
-    int textureHeight;
-    int textureChannels;
-
-    for (unsigned i = 0; i < textureFaces.size(); ++i) {
-        textureData = stbi_load(textureFaces[i].c_str(), &textureWidth, &textureHeight, &textureChannels, 0);
-
-        if (textureData) {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, textureWidth, textureHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-            stbi_image_free(textureData);
-        }
-        else {
-            std::cerr << "Failed to load skybox texture: " << textureFaces[i] << std::endl;
-            stbi_image_free(textureData);
-            return 1;
-        }
+    // Faces are decoded in parallel on the first launch, the resulting texture data (compressed, with mipmaps) is cached
+    // on disk and uploaded directly on subsequent launches.
+    std::unique_ptr<OpenGL::Cubemap> skybox;
+    try {
+        skybox = std::make_unique<OpenGL::Cubemap>(textureFaces, "src/samples/path-tracing/data/cache/");
     }
-
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-    // RGBA.
-    std::vector<float> blankTexture;
-    blankTexture.resize(width * height * 4, 0.0f);
-
-    GLuint frame1;
-    glGenTextures(1, &frame1);
-    glBindTexture(GL_TEXTURE_2D, frame1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    GLuint frame2;
-    glGenTextures(1, &frame2);
-    glBindTexture(GL_TEXTURE_2D, frame2);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    GLuint postProcessingFrame;
-    glGenTextures(1, &postProcessingFrame);
-    glBindTexture(GL_TEXTURE_2D, postProcessingFrame);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, blankTexture.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // Depth buffer.
-    GLuint rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-    // Initialize custom framebuffer.
-    GLuint fbo;
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame1, 0);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, frame2, 0);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, postProcessingFrame, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "Failed to initialize custom framebuffer on startup." << std::endl;
+    catch (const std::runtime_error& error) {
+        std::cerr << error.what() << std::endl;
         return 1;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    std::vector<GLenum> drawBuffers(1);
-
-    // Initialize global data UBO.
-    GLuint ubo;
-    glGenBuffers(1, &ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, ubo); // Binding 0.
-
-    // Inverse camera transforms (2x mat4), camera position (vec3, vec4 with padding).
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2 + sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    // Initialize scene objects.
-    const int numSpheres = 256;
-    std::vector<OpenGL::Sphere> spheres(numSpheres);
-    int numActiveSpheres = 0;
-
-    const int numAABBs = 256;
-    std::vector<OpenGL::AABB> aabbs(numAABBs);
-    int numActiveAABBs = 0;
-
-    int index = 0;
+    // Bright regions of the skybox are sampled explicitly from diffuse surfaces.
+    OpenGL::EnvironmentDistribution environmentDistribution(*skybox);
+    environmentDistribution.Bind(2); // Binding 2.
+    bool environmentImportanceSampling = true;
 
-    // 6x6 grid of spheres to showcase varying levels of both reflective materials and reflection roughness properties.
-    {
-        int side = 6;
-        float radius = 2.0f;
-        float gap = 1.0f;
-
-        float length = (radius * 2.0f) * static_cast<float>(side) + gap * static_cast<float>(side);
-        float offset = length / 2.0f;
-        float delta = length / static_cast<float>(side - 1);
-
-        for (int y = 0; y < side; ++y) {
-            for (int x = 0; x < side; ++x) {
-                OpenGL::Sphere& sphere = spheres[index++];
-                sphere.radius = radius;
-                sphere.position = glm::vec3(15.0f, static_cast<float>(y) * delta - offset, static_cast<float>(x) * delta - offset);
-
-                // Configure material properties.
-                OpenGL::Material& material = sphere.material;
-                material.albedo = glm::vec3(1.0f);
-                material.reflectionProbability = static_cast<float>(side - 1 - x) / (static_cast<float>(side - 1));
-                material.reflectionRoughness = static_cast<float>(y) / (static_cast<float>(side - 1));
-
-                ++numActiveSpheres;
-            }
-        }
-    }
+    // Rough reflections of the skybox use a GGX prefiltered copy, built once on the GPU.
+    // Levels are filtered across cube faces.
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
-    // 1x6 grid of spheres to showcase refractive materials with varying levels of absorbance (Beer's Law).
+    std::unique_ptr<OpenGL::PrefilteredEnvironment> prefilteredSkybox;
     {
-        int side = 6;
-        float radius = 2.0f;
-        float gap = 1.0f;
-
-        float length = (radius * 2.0f) * static_cast<float>(side) + gap * static_cast<float>(side);
-        float offset = length / 2.0f;
-        float delta = length / static_cast<float>(side - 1);
-
-        for (int i = 0; i < side; ++i) {
-            OpenGL::Sphere& sphere = spheres[index++];
-            sphere.radius = radius;
-            sphere.position = glm::vec3(-15.0f, length / 4.0f, static_cast<float>(i) * delta - offset);
-
-            // Configure material properties.
-            OpenGL::Material& material = sphere.material;
-            material.albedo = glm::vec3(0.90f, 0.25f, 0.25f);
-            material.ior = 1.05f;
-            material.refractionProbability = 0.98f;
-            material.absorbance = glm::vec3(1.0f, 2.0f, 3.0f) * (static_cast<float>(i) / static_cast<float>(side));
-            material.reflectionProbability = 0.02f;
-
-            ++numActiveSpheres;
-        }
+        OpenGL::Shader prefilterShader { "Prefilter Environment", { "src/samples/path-tracing/assets/shaders/prefilter_environment.comp" } };
+        prefilteredSkybox = std::make_unique<OpenGL::PrefilteredEnvironment>(*skybox, prefilterShader);
     }
-
-    // 1x6 grid of spheres to showcase refractive materials with varying levels of refraction roughness.
-    {
-        int side = 6;
-        float radius = 2.0f;
-        float gap = 1.0f;
-
-        float length = (radius * 2.0f) * static_cast<float>(side) + gap * static_cast<float>(side);
-        float offset = length / 2.0f;
-        float delta = length / static_cast<float>(side - 1);
-
-        for (int i = 0; i < side; ++i) {
-            OpenGL::Sphere& sphere = spheres[index++];
-            sphere.radius = radius;
-            sphere.position = glm::vec3(-15.0f, -length / 4.0f, static_cast<float>(i) * delta - offset);
-
-            // Configure material properties.
-            OpenGL::Material& material = sphere.material;
-            material.ior = 1.1f;
-            material.refractionProbability = 0.98f;
-            material.refractionRoughness = (static_cast<float>(side - 1 - i) / static_cast<float>(side));
-            material.reflectionProbability = 0.02f;
-            material.reflectionRoughness = (static_cast<float>(i) / static_cast<float>(side));
-
-            ++numActiveSpheres;
+    bool prefilteredReflections = true;
+
+    // Path tracing happens at an internal resolution that is a fraction of the window resolution.
+    // The accumulated image is upscaled to the window resolution before post-processing.
+    float resolutionScale = 1.0f;
+    bool dynamicResolution = true;
+    float targetPathTracingTime = 33.3f; // Milliseconds.
+    float minimumResolutionScale = 0.25f;
+    int upscaleFilter = 1; // Edge-aware.
+    float edgeSharpness = 8.0f;
+
+    int internalWidth = width;
+    int internalHeight = height;
+
+    // Render target precision.
+    // In-place accumulation reads and writes a single image (every pixel only ever touches itself), while ping-pong
+    // accumulation reads the previous frame and writes the current frame into a second image.
+    // Half precision accumulation keeps the number of accumulated samples in a separate 32-bit image, as the blend weight
+    // (1 / sample count) cannot be represented accurately enough in the alpha channel after a few thousand samples.
+    bool inPlaceAccumulation = true;
+    int accumulationPrecision = 0; // RGBA32F, RGBA16F.
+    int outputPrecision = 0; // RGBA8, RGB10_A2.
+
+    const GLenum accumulationFormats[] = { GL_RGBA32F, GL_RGBA16F };
+    const char* accumulationFormatQualifiers[] = { "rgba32f", "rgba16f" };
+    const int accumulationFormatSizes[] = { 16, 8 }; // Bytes per pixel.
+
+    const GLenum outputFormats[] = { GL_RGBA8, GL_RGB10_A2 };
+    const char* outputFormatQualifiers[] = { "rgba8", "rgb10_a2" };
+
+    const GLenum upscaledFormat = GL_RGBA16F; // Intermediate radiance at window resolution, before tonemapping.
+
+    bool reallocateAccumulationTargets = false;
+    bool reallocateOutputTarget = false;
+
+    // Render targets use immutable storage: a change in dimensions or format recreates the texture rather than
+    // respecifying it, and contents are cleared on the GPU instead of being uploaded from a blank CPU-side buffer.
+    auto createRenderTarget = [](GLuint& texture, GLenum format, int targetWidth, int targetHeight, GLenum filter) {
+        if (texture) {
+            glDeleteTextures(1, &texture);
         }
-    }
 
-    index = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, format, targetWidth, targetHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    };
 
-    // Box consisting of 6 thin AABB slabs around the demo scene.
-    {
-        float epsilon = 0.01f;
-        float boxHeight = 40.0f;
-        float boxWidth = 40.0f;
-        float boxDepth = 56.0f;
+    // Accumulation images are also sampled (filtered) by the upscale pass.
+    // The second accumulation image and the sample count image are only allocated at full size when in use.
+    GLuint frame1 = 0;
+    GLuint frame2 = 0;
+    GLuint sampleCountFrame = 0;
 
-        // Right wall (green).
-        {
-            OpenGL::AABB& wall = aabbs[index++];
-            wall.position = glm::vec4(boxWidth / 2.0f, 0.0f, 0.0f, 1.0f);
-            wall.dimensions = glm::vec4(epsilon, boxHeight / 2.0f + epsilon, boxDepth / 2.0f + epsilon, 0.0f);
+    auto clearAccumulationTargets = [&](GLuint accumulationImage) {
+        // A null pointer clears to zero.
+        glClearTexImage(accumulationImage, 0, GL_RGBA, GL_FLOAT, nullptr);
 
-            OpenGL::Material& material = wall.material;
-            material.albedo = glm::vec3(0.37f, 0.67f, 0.37f);
-            material.reflectionProbability = 1.0f;
-            material.reflectionRoughness = 0.6f;
-
-            ++numActiveAABBs;
+        if (accumulationPrecision == 1) {
+            glClearTexImage(sampleCountFrame, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
         }
+    };
 
-        // Left wall (transparent).
-        {
-            OpenGL::AABB& wall = aabbs[index++];
-            wall.position = glm::vec4(-boxWidth / 2.0f, 0.0f, 0.0f, 1.0f);
-            wall.dimensions = glm::vec4(epsilon, boxHeight / 2.0f + epsilon, boxDepth / 2.0f + epsilon, 0.0f);
-
-            OpenGL::Material& material = wall.material;
-            material.albedo = glm::vec3(1.0f);
-            material.ior = 1.52f; // Glass.
-            material.refractionProbability = 1.0f;
-            material.absorbance = glm::vec3(0.1f);
+    auto createAccumulationTargets = [&]() {
+        createRenderTarget(frame1, accumulationFormats[accumulationPrecision], internalWidth, internalHeight, GL_LINEAR);
 
-            ++numActiveAABBs;
+        if (inPlaceAccumulation) {
+            createRenderTarget(frame2, accumulationFormats[accumulationPrecision], 1, 1, GL_LINEAR);
         }
-
-        // Back wall (blue).
-        {
-            OpenGL::AABB& wall = aabbs[index++];
-            wall.position = glm::vec4(0.0f, 0.0f, boxDepth / 2.0f, 1.0f);
-            wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, boxHeight / 2.0f + epsilon, epsilon, 0.0f);
-
-            OpenGL::Material& material = wall.material;
-            material.albedo = glm::vec3(0.07f, 0.25f, 0.45f);
-            material.reflectionProbability = 1.0f;
-            material.reflectionRoughness = 0.6f;
-
-            ++numActiveAABBs;
+        else {
+            createRenderTarget(frame2, accumulationFormats[accumulationPrecision], internalWidth, internalHeight, GL_LINEAR);
         }
 
-        // Front wall (reflective).
-        {
-            OpenGL::AABB& wall = aabbs[index++];
-            wall.position = glm::vec4(0.0f, 0.0f, -boxDepth / 2.0f, 1.0f);
-            wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, boxHeight / 2.0f + epsilon, epsilon, 0.0f);
-
-            OpenGL::Material& material = wall.material;
-            material.albedo = glm::vec3(0.95f, 0.75f, 0.30f);
-            material.reflectionProbability = 1.0f;
-            material.reflectionRoughness = 0.25f;
-
-            ++numActiveAABBs;
+        if (accumulationPrecision == 1) {
+            createRenderTarget(sampleCountFrame, GL_R32UI, internalWidth, internalHeight, GL_NEAREST);
         }
-
-        // Floor (red).
-        {
-            OpenGL::AABB& wall = aabbs[index++];
-
-            wall.position = glm::vec4(0.0f, -boxHeight / 2.0f, 0.0f, 1.0f);
-            wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, epsilon, boxDepth / 2.0f + epsilon, 0.0f);
-
-            OpenGL::Material& material = wall.material;
-            material.albedo = glm::vec3(0.2f, 0.04f, 0.04f);
-            material.reflectionProbability = 1.0f;
-            material.reflectionRoughness = 0.6f;
-
-            ++numActiveAABBs;
+        else {
+            createRenderTarget(sampleCountFrame, GL_R32UI, 1, 1, GL_NEAREST);
         }
 
-        // Ceiling (transparent).
-        {
-            OpenGL::AABB& wall = aabbs[index++];
-            wall.position = glm::vec4(0.0f, boxHeight / 2.0f, 0.0f, 1.0f);
-            wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, epsilon, boxDepth / 2.0f + epsilon, 0.0f);
-
-            OpenGL::Material& material = wall.material;
-            material.ior = 1.52f; // Glass.
-            material.refractionProbability = 1.0f;
-            material.absorbance = glm::vec3(0.1f);
-
-            ++numActiveAABBs;
+        clearAccumulationTargets(frame1);
+        if (!inPlaceAccumulation) {
+            clearAccumulationTargets(frame2);
         }
+    };
 
-        // Light.
-        {
-            OpenGL::AABB& light = aabbs[index++];
-            light.position = glm::vec4(0.0f, boxHeight / 2.0f - 2.0f, 0.0f, 1.0f);
-            light.dimensions = glm::vec4(boxWidth / 6.0f, epsilon, boxDepth / 6.0f, 0.0f);
+    // Window resolution targets.
+    // All passes are compute shaders writing directly to images.
+    // The framebuffer only exists to blit the final output to the default framebuffer, and is rebuilt to reference the
+    // recreated output texture.
+    GLuint upscaledFrame = 0;
+    GLuint postProcessingFrame = 0;
+    GLuint outputFBO = 0;
 
-            OpenGL::Material& material = light.material;
-            material.emissive = glm::vec3(1.0f);
-            material.emissiveStrength = 15.0f;
-            material.reflectionProbability = 1.0f;
+    auto createOutputTargets = [&]() -> bool {
+        createRenderTarget(upscaledFrame, upscaledFormat, width, height, GL_NEAREST);
+        createRenderTarget(postProcessingFrame, outputFormats[outputPrecision], width, height, GL_NEAREST);
 
-            ++numActiveAABBs;
+        if (outputFBO) {
+            glDeleteFramebuffers(1, &outputFBO);
         }
-    }
-
-    GLuint ssbo;
-    glGenBuffers(1, &ssbo);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, ssbo); // Binding 1.
-
-    // Number of active spheres (int, vec4 with padding), array of 256 spheres.
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + numSpheres * sizeof(OpenGL::Sphere) + sizeof(glm::vec4) + numAABBs * sizeof(OpenGL::AABB), nullptr, GL_STATIC_DRAW);
-
-    {
-        std::size_t offset = 0;
 
-        // Set sphere object data.
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(int), &numActiveSpheres);
-        offset += sizeof(glm::vec4);
+        glGenFramebuffers(1, &outputFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, postProcessingFrame, 0);
 
-        for (int i = 0; i < numActiveSpheres; ++i) {
-            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(OpenGL::Sphere), &spheres[i]);
-            offset += sizeof(OpenGL::Sphere);
-        }
-        offset += (numSpheres - numActiveSpheres) * sizeof(OpenGL::Sphere);
+        bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return isComplete;
+    };
 
-        // Set AABB object data.
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(int), &numActiveAABBs);
-        offset += sizeof(glm::vec4);
+    createAccumulationTargets();
 
-        for (int i = 0; i < numActiveAABBs; ++i) {
-            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(OpenGL::AABB), &aabbs[i]);
-            offset += sizeof(OpenGL::AABB);
-        }
-        offset += (numAABBs - numActiveAABBs) * sizeof(OpenGL::AABB);
+    if (!createOutputTargets()) {
+        std::cerr << "Failed to initialize custom output framebuffer on startup." << std::endl;
+        return 1;
     }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Render targets are only recreated once the window size has settled, instead of on every frame of an interactive
+    // resize. Until then, the previous render targets are stretched over the window.
+    const double resizeDebounceTime = 0.1; // Seconds.
+    int pendingWidth = width;
+    int pendingHeight = height;
+    double pendingResizeTime = 0.0;
+
+    // Screenshots are read back and written to disk asynchronously.
+    OpenGL::ImageCapture imageCapture;
+
+    // Frame sequences are streamed to disk through a bounded queue.
+    // Every recorded frame accumulates a fixed number of frames (and therefore samples per pixel) before it is captured.
+    OpenGL::FrameRecorder frameRecorder;
+    int framesPerRecordedFrame = 16;
+    bool recordTurntable = false;
+    float turntableDegreesPerFrame = 2.0f;
+    bool recordedFrameCaptured = false;
+
+    // GPU time of the path tracing pass drives the dynamic resolution controller.
+    OpenGL::GPUTimer pathTracingTimer;
+
+    // Wavefront path tracing, see wavefront_path_tracer.h.
+    bool wavefrontPathTracing = false;
+    bool sortSecondaryRays = true;
+
+    // Utilization of subgroups while shading, measured with subgroup ballots.
+    const bool simdStatisticsSupported = glfwExtensionSupported("GL_ARB_shader_ballot") && glfwExtensionSupported("GL_ARB_gpu_shader_int64");
+    bool measureSIMDEfficiency = false;
+    float simdEfficiency = 0.0f;
+    unsigned raysPerFrame = 0;
+    OpenGL::AsyncReadback simdStatisticsReadback;
+
+    // Rays traced, path depths and the reasons paths end, counted by the path tracing shader(s).
+    bool measureRayStatistics = false;
+    OpenGL::RayStatistics rayStatistics { };
+    float rayStatisticsFrameTime = 0.0f; // Seconds, at the time the statistics were gathered.
+    OpenGL::AsyncReadback rayStatisticsReadback;
+
+    // Per-pixel cost heatmaps, see DEBUG_VIEW in path_tracing.comp.
+    // Off, intersection tests, bounces, rays traced, shader clock (thousands of cycles).
+    const bool shaderClockSupported = glfwExtensionSupported("GL_ARB_shader_clock");
+    int debugView = 0;
+    float heatmapMaximums[] = { 1.0f, 512.0f, 8.0f, 8.0f, 100.0f }; // Cost mapped to the hottest color, per debug view.
+
+    // Tiled progressive rendering.
+    // Every pass over the image is split into tiles, each frame only path traces as many tiles as fit into a GPU time
+    // budget and the next frame continues where the previous one stopped. This keeps the UI responsive (and individual
+    // submissions short enough to not trigger GPU watchdog resets) at high sample / bounce counts.
+    bool tiledRendering = true;
+    int tileSize = 64;
+    int tileOrder = 0; // Morton (Z-order), spiral from the cursor.
+    float tileTimeBudget = 16.0f; // Milliseconds.
+
+    std::vector<glm::ivec2> tiles; // Tile coordinates in processing order for the current pass.
+    int nextTile = 0;
+    int tilesPerFrame = 1;
+
+    // GPU time of the first tile of every frame, averaged, is the estimated cost of rendering one tile.
+    OpenGL::GPUTimer tileTimer;
 
-    // Initialize necessary buffers for a full-screen quad.
-    std::vector<glm::vec3> vertices = {
-        { -1.0f, 1.0f, 0.0f },
-        { -1.0f, -1.0f, 0.0f },
-        { 1.0f, -1.0f, 0.0f },
-        { 1.0f, 1.0f, 0.0f }
-    };
-    std::vector<glm::vec2> uv = {
-        { 0.0f, 1.0f },
-        { 0.0f, 0.0f },
-        { 1.0f, 0.0f },
-        { 1.0f, 1.0f },
-    };
-    std::vector<unsigned> indices = { 0, 1, 2, 0, 2, 3 };
+    // Initialize global data UBO.
+    GLuint ubo;
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, ubo); // Binding 0.
 
-    GLuint verticesVBO;
-    glGenBuffers(1, &verticesVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Inverse camera transforms (2x mat4), camera position (vec3, vec4 with padding).
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2 + sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
 
-    GLuint uvVBO;
-    glGenBuffers(1, &uvVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, uvVBO);
-    glBufferData(GL_ARRAY_BUFFER, uv.size() * sizeof(uv[0]), uv.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    GLuint ebo;
-    glGenBuffers(1, &ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(indices[0]), indices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // Initialize scene objects.
+    OpenGL::Scene scene;
 
-    GLuint vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    std::vector<OpenGL::Sphere>& spheres = scene.GetSpheres();
+    std::vector<OpenGL::AABB>& aabbs = scene.GetAABBs();
+    std::vector<OpenGL::Instance>& instances = scene.GetInstances();
+    std::vector<OpenGL::Transform>& instanceTransforms = scene.GetInstanceTransforms();
 
-    // Attach VBOs.
-    glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+    const int numActiveSpheres = scene.GetNumActiveSpheres();
+    const int numActiveAABBs = scene.GetNumActiveAABBs();
 
-    glBindBuffer(GL_ARRAY_BUFFER, uvVBO);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), nullptr);
+    // Active invocations, issued invocations, rays traced.
+    GLuint simdStatisticsBuffer;
+    glGenBuffers(1, &simdStatisticsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, simdStatisticsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, 3 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, simdStatisticsBuffer); // Binding 7.
 
-    // Attach EBO.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    GLuint rayStatisticsBuffer;
+    glGenBuffers(1, &rayStatisticsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayStatisticsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(OpenGL::RayStatistics), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, rayStatisticsBuffer); // Binding 8.
 
-    glBindVertexArray(0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
     // Timestep.
     float current;
@@ -490,20 +622,66 @@ int main() {
     float dt = 0.0f;
 
     // Compile shaders.
-    OpenGL::Shader pathTracingShader { "Path Tracing", { "src/samples/path-tracing/assets/shaders/fsq.vert",
-                                                         "src/samples/path-tracing/assets/shaders/path_tracing.frag" } };
-    OpenGL::Shader postProcessingShader { "Post Processing", { "src/samples/path-tracing/assets/shaders/fsq.vert",
-                                                               "src/samples/path-tracing/assets/shaders/post_processing.frag" } };
+    // Work group dimensions of the path tracing shader are tunable at runtime, the shader is recompiled when they change.
+    const std::vector<glm::ivec2> workGroupSizes = { { 8, 4 }, { 8, 8 }, { 16, 8 }, { 16, 16 }, { 32, 4 }, { 32, 8 }, { 32, 32 } };
+    int workGroupSizeIndex = 1; // 8x8.
+
+    // Render target formats and the accumulation mode are compile-time constants as well.
+    bool recompilePathTracingShader = false;
+
+    auto getPathTracingDefines = [&]() -> std::vector<OpenGL::Shader::ShaderDefine> {
+        std::vector<OpenGL::Shader::ShaderDefine> defines = { { "WORK_GROUP_SIZE_X", std::to_string(workGroupSizes[workGroupSizeIndex].x) },
+                                                              { "WORK_GROUP_SIZE_Y", std::to_string(workGroupSizes[workGroupSizeIndex].y) },
+                                                              { "ACCUMULATION_FORMAT", accumulationFormatQualifiers[accumulationPrecision] } };
+        if (inPlaceAccumulation) {
+            defines.emplace_back("IN_PLACE_ACCUMULATION", "1");
+        }
+        if (accumulationPrecision == 1) {
+            defines.emplace_back("SEPARATE_SAMPLE_COUNT", "1");
+        }
+        if (measureSIMDEfficiency) {
+            defines.emplace_back("SIMD_STATISTICS", "1");
+        }
+        if (measureRayStatistics) {
+            defines.emplace_back("RAY_STATISTICS", "1");
+        }
+        if (debugView > 0) {
+            defines.emplace_back("DEBUG_VIEW", std::to_string(debugView));
+        }
+
+        return defines;
+    };
+
+    auto createPathTracingShader = [&]() -> std::unique_ptr<OpenGL::Shader> {
+        return std::make_unique<OpenGL::Shader>("Path Tracing", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/path_tracing.comp" }, getPathTracingDefines());
+    };
+
+    auto createPostProcessingShader = [&]() -> std::unique_ptr<OpenGL::Shader> {
+        return std::make_unique<OpenGL::Shader>("Post Processing", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/post_processing.comp" },
+                                                std::vector<OpenGL::Shader::ShaderDefine> { { "OUTPUT_FORMAT", outputFormatQualifiers[outputPrecision] } });
+    };
+
+    std::unique_ptr<OpenGL::Shader> pathTracingShader = createPathTracingShader();
+
+    // Only created while wavefront path tracing is enabled.
+    std::unique_ptr<OpenGL::WavefrontPathTracer> wavefrontPathTracer;
+
+    OpenGL::Shader upscaleShader { "Upscale", { "src/samples/path-tracing/assets/shaders/upscale.comp" } };
+    std::unique_ptr<OpenGL::Shader> postProcessingShader = createPostProcessingShader();
 
     int frameCounter = 0;
     int samplesPerPixel = 1;
     int numRayBounces = 16;
 
-    glBindVertexArray(vao);
-
     while ((glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS) && (glfwWindowShouldClose(window) == 0)) {
         glfwPollEvents();
 
+        // Write out any screenshots / recorded frames the GPU has finished reading back.
+        imageCapture.Update();
+        simdStatisticsReadback.Update();
+        rayStatisticsReadback.Update();
+        frameRecorder.Update();
+
         // Start the Dear ImGui frame.
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -516,54 +694,58 @@ int main() {
         int tempHeight;
         glfwGetFramebufferSize(window, &tempWidth, &tempHeight);
 
-        if (tempWidth != width || tempHeight != height) {
-            // Window dimensions changed, resize content.
-            width = tempWidth;
-            height = tempHeight;
-
-            blankTexture.resize(width * height * 4, 0.0f); // Inserts or deletes elements appropriately.
-
-            // Reallocate FBO attachments with updated data storage size.
-            glBindTexture(GL_TEXTURE_2D, frame1);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-            glBindTexture(GL_TEXTURE_2D, 0);
-
-            glBindTexture(GL_TEXTURE_2D, frame2);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-            glBindTexture(GL_TEXTURE_2D, 0);
-
-            glBindTexture(GL_TEXTURE_2D, postProcessingFrame);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-            glBindTexture(GL_TEXTURE_2D, 0);
-
-            glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        if (tempWidth != pendingWidth || tempHeight != pendingHeight) {
+            // Window is (still) being resized, restart the debounce timer.
+            pendingWidth = tempWidth;
+            pendingHeight = tempHeight;
+            pendingResizeTime = glfwGetTime();
+        }
 
-            // Reconstruct custom frame buffer.
-            // Note: not sure if this fully necessary, resizing doesn't happen every frame so the performance overhead is negligible.
-            glDeleteFramebuffers(1, &fbo);
+        // Minimized windows have a framebuffer size of zero, keep the existing render targets until the window is restored.
+        bool resizeSettled = glfwGetTime() - pendingResizeTime >= resizeDebounceTime;
 
-            glGenFramebuffers(1, &fbo);
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame1, 0);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, frame2, 0);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, postProcessingFrame, 0);
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
+        if ((pendingWidth != width || pendingHeight != height) && resizeSettled && pendingWidth > 0 && pendingHeight > 0) {
+            // Window dimensions changed, resize content.
+            width = pendingWidth;
+            height = pendingHeight;
 
-            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-                std::cerr << "Failed to reinitialize custom framebuffer on window resize." << std::endl;
+            // Accumulation images are recreated below, once the new internal resolution is known.
+            if (!createOutputTargets()) {
+                std::cerr << "Failed to reinitialize custom output framebuffer on window resize." << std::endl;
                 break;
             }
 
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-            // Update viewport.
-            glViewport(0, 0, width, height);
-
             // Update camera.
             float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
             camera.SetAspectRatio(aspectRatio);
+            refreshRenderTargets = true;
+        }
+
+        bool pathTracingTimerUpdated = pathTracingTimer.Update();
+        bool tileTimerUpdated = tileTimer.Update();
+
+        int numTilesX = (internalWidth + tileSize - 1) / tileSize;
+        int numTilesY = (internalHeight + tileSize - 1) / tileSize;
+
+        // Dynamic resolution scaling.
+        // Path tracing cost is proportional to the number of pixels, which scales with the square of the resolution scale.
+        // Measurements are only acted on once a few have been collected at the current internal resolution, and small
+        // deviations from the target are ignored (hysteresis) as every change in resolution restarts accumulation.
+        // With tiled rendering a frame only covers part of the image, the time of a full pass is estimated from the time per tile.
+        OpenGL::GPUTimer& passTimer = tiledRendering ? tileTimer : pathTracingTimer;
+        bool passTimerUpdated = tiledRendering ? tileTimerUpdated : pathTracingTimerUpdated;
+        float passTime = tiledRendering ? tileTimer.GetAverageMilliseconds() * static_cast<float>(numTilesX * numTilesY) : pathTracingTimer.GetAverageMilliseconds();
+
+        if (passTimerUpdated && dynamicResolution && passTimer.GetNumMeasurements() >= 4) {
+            float measuredTime = glm::max(passTime, 0.01f);
+            float ratio = targetPathTracingTime / measuredTime;
+            const float tolerance = 0.15f;
+
+            if (ratio < 1.0f - tolerance || ratio > 1.0f + tolerance) {
+                // Limit the step size to avoid overshooting on outlier measurements.
+                float scale = resolutionScale * glm::clamp(glm::sqrt(ratio), 0.5f, 1.25f);
+                resolutionScale = glm::clamp(scale, minimumResolutionScale, 1.0f);
+            }
         }
 
         // Moving camera.
@@ -650,12 +832,31 @@ int main() {
             initialInput = true;
         }
 
+        // Start accumulating the next recorded frame.
+        if (recordedFrameCaptured) {
+            recordedFrameCaptured = false;
+
+            if (recordTurntable) {
+                // Orbit the camera around the center of the scene.
+                glm::vec3 position = glm::vec3(glm::rotate(glm::radians(turntableDegreesPerFrame), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::vec4(camera.GetPosition(), 1.0f));
+                camera.SetPosition(position);
+
+                if (glm::length(position) > std::numeric_limits<float>::epsilon()) {
+                    glm::vec3 direction = glm::normalize(-position);
+                    camera.SetEulerAngles(glm::degrees(glm::asin(direction.y)), glm::degrees(glm::atan(direction.z, direction.x)), 0.0f);
+                }
+            }
+
+            refreshRenderTargets = true;
+        }
+
         bool isCameraDirty = camera.IsDirty();
         glm::mat4 inverseProjectionMatrix = glm::inverse(camera.GetPerspectiveTransform());
         glm::mat4 inverseViewMatrix = glm::inverse(camera.GetViewTransform());
 
         static bool sphereSelected = false;
         static bool aabbSelected = false;
+        static bool instanceSelected = false;
         static int currentSelectedObjectIndex = -1;
 
         // Mouse picking.
@@ -664,6 +865,7 @@ int main() {
         if ((newState == GLFW_RELEASE && previousState == GLFW_PRESS) && !io.WantCaptureMouse) {
             sphereSelected = false;
             aabbSelected = false;
+            instanceSelected = false;
 
             int previouslySelectedObjectIndex = currentSelectedObjectIndex;
             bool selectedObject = false;
@@ -691,108 +893,38 @@ int main() {
 
             // Intersect with all active spheres.
             for (int i = 0; i < numActiveSpheres; ++i) {
-                OpenGL::Sphere& temp = spheres[i];
-
-                glm::vec3 sphereToRayOrigin = rayOrigin - temp.position;
-
-                // https://antongerdelan.net/opengl/raycasting.html
-                float b = dot(rayDirection, sphereToRayOrigin);
-                float c = dot(sphereToRayOrigin, sphereToRayOrigin) - (temp.radius * temp.radius);
-
-                float discriminant = b * b - c;
-                if (discriminant < 0.0) {
-                    // No real roots, no intersection.
-                    continue;
-                }
-
-                float sqrtDiscriminant = sqrt(discriminant);
-
-                float t1 = -b - sqrtDiscriminant;
-                float t2 = -b + sqrtDiscriminant;
-
-                if (t2 < 0.0) {
-                    // Ray exited behind the origin (sphere is behind the camera).
-                    continue;
-                }
+                if (spheres[i].Intersects(rayOrigin, rayDirection, tMin, tMax)) {
+                    sphereSelected = true;
+                    aabbSelected = false;
+                    instanceSelected = false;
 
-                // Bounds check.
-                float t = t1 < 0.0 ? t2 : t1;
-                if (t < tMin || t > tMax) {
-                    // Closer intersection has already been found.
-                    continue;
+                    currentSelectedObjectIndex = i;
+                    selectedObject = true;
                 }
-
-                // Update bounds.
-                tMax = t;
-
-                sphereSelected = true;
-                aabbSelected = false;
-
-                currentSelectedObjectIndex = i;
-                selectedObject = true;
             }
 
             // Intersect with all active AABBs.
             for (int i = 0; i < numActiveAABBs; ++i) {
-                OpenGL::AABB& temp = aabbs[i];
-
-                glm::vec3 minimum = temp.position - temp.dimensions;
-                glm::vec3 maximum = temp.position + temp.dimensions;
+                if (aabbs[i].Intersects(rayOrigin, rayDirection, tMin, tMax)) {
+                    aabbSelected = true;
+                    sphereSelected = false;
+                    instanceSelected = false;
 
-                // Taken from Real Time Collision Detection, Chapter 5.
-                float currentTMin = 0.0f;
-                float currentTMax = std::numeric_limits<float>::max();
-
-                bool invalid = false;
-
-                for (int axis = 0; axis < 3; ++axis) {
-                    if (glm::abs(rayDirection[axis]) < std::numeric_limits<float>::epsilon()) {
-                        // Ray is parallel to the slab, no intersection can happen unless the origin is within the bounds of the slab.
-                        if (rayOrigin[axis] < minimum[axis] || rayOrigin[axis] > maximum[axis]) {
-                            invalid = true;
-                            break;
-                        }
-                    }
-                    else {
-                        // Compute times at which ray enters and leaves the slab.
-                        float inverseDirection = 1.0f / rayDirection[axis];
-                        float t1 = (minimum[axis] - rayOrigin[axis]) * inverseDirection;
-                        float t2 = (maximum[axis] - rayOrigin[axis]) * inverseDirection;
-
-                        // Make t1 be the intersection time with the near plane, t2 be the intersection time with the far plane.
-                        if (t1 > t2) {
-                            std::swap(t1, t2);
-                        }
-
-                        currentTMin = glm::max(currentTMin, t1);
-                        currentTMax = glm::min(currentTMax, t2);
-
-                        if (currentTMin > currentTMax) {
-                            invalid = true;
-                            break;
-                        }
-                    }
+                    currentSelectedObjectIndex = i;
+                    selectedObject = true;
                 }
+            }
 
-                if (invalid) {
-                    continue;
-                }
+            // Intersect with all instances.
+            for (int i = 0; i < static_cast<int>(instances.size()); ++i) {
+                if (instances[i].Intersects(spheres, aabbs, rayOrigin, rayDirection, tMin, tMax)) {
+                    instanceSelected = true;
+                    sphereSelected = false;
+                    aabbSelected = false;
 
-                // Intersection time is currentTMin.
-                // Bounds check.
-                if (currentTMin < tMin || currentTMin > tMax) {
-                    // Closer intersection has already been found.
-                    continue;
+                    currentSelectedObjectIndex = i;
+                    selectedObject = true;
                 }
-
-                // Update bounds.
-                tMax = currentTMin;
-
-                aabbSelected = true;
-                sphereSelected = false;
-
-                currentSelectedObjectIndex = i;
-                selectedObject = true;
             }
 
             if (selectedObject) {
@@ -819,9 +951,7 @@ int main() {
 
                 bool updateGPUData = object.OnImGui();
                 if (updateGPUData) {
-                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-                    glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + (currentSelectedObjectIndex) * sizeof(OpenGL::Sphere), sizeof(OpenGL::Sphere), &object);
-                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+                    scene.UpdateSphere(currentSelectedObjectIndex);
 
                     refreshRenderTargets = true;
                 }
@@ -835,9 +965,47 @@ int main() {
 
                 bool updateGPUData = object.OnImGui();
                 if (updateGPUData) {
-                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-                    glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + numSpheres * sizeof(OpenGL::Sphere) + sizeof(glm::vec4) + currentSelectedObjectIndex * sizeof(OpenGL::AABB), sizeof(OpenGL::AABB), &object);
-                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+                    scene.UpdateAABB(currentSelectedObjectIndex);
+
+                    refreshRenderTargets = true;
+                }
+            }
+            else if (instanceSelected) {
+                OpenGL::Instance& object = instances[currentSelectedObjectIndex];
+                OpenGL::Transform& transform = instanceTransforms[currentSelectedObjectIndex];
+
+                if (focusOnClick) {
+                    focusDistance = glm::distance(transform.GetPosition(), cameraPosition);
+                }
+
+                bool updateGPUData = false;
+
+                glm::vec3 position = transform.GetPosition();
+                ImGui::Text("Position:");
+                if (ImGui::DragFloat3("##position", &position.x, 0.05f)) {
+                    transform.SetPosition(position);
+                    updateGPUData = true;
+                }
+
+                glm::vec3 rotation = transform.GetRotation();
+                ImGui::Text("Rotation:");
+                if (ImGui::DragFloat3("##rotation", &rotation.x, 0.5f)) {
+                    transform.SetRotation(rotation);
+                    updateGPUData = true;
+                }
+
+                glm::vec3 scale = transform.GetScale();
+                ImGui::Text("Scale:");
+                if (ImGui::DragFloat3("##scale", &scale.x, 0.01f, 0.01f, 10.0f)) {
+                    // Manual input can go outside the valid range.
+                    transform.SetScale(glm::clamp(scale, glm::vec3(0.01f), glm::vec3(10.0f)));
+                    updateGPUData = true;
+                }
+
+                if (updateGPUData) {
+                    object.SetTransform(transform.GetTransform());
+
+                    scene.UpdateInstance(currentSelectedObjectIndex);
 
                     refreshRenderTargets = true;
                 }
@@ -877,32 +1045,138 @@ int main() {
             ImGui::Text("Render time:");
             ImGui::Text("%.3f ms/frame (%.1f FPS)", dt * 1000.0f, 1.0f / dt);
 
+            if (measureRayStatistics) {
+                ImGui::Separator();
+
+                // Per frame, and per second (millions).
+                float perSecond = rayStatisticsFrameTime > 0.0f ? 1.0f / (rayStatisticsFrameTime * 1000000.0f) : 0.0f;
+                auto rayCount = [perSecond](const char* label, GLuint count) {
+                    ImGui::Text("%s: %u/frame (%.2f M/s)", label, count, static_cast<float>(count) * perSecond);
+                };
+
+                ImGui::Text("Ray statistics:");
+                rayCount("Primary rays", rayStatistics.numPrimaryRays);
+                rayCount("Bounce rays", rayStatistics.numBounceRays);
+                rayCount("Shadow rays", rayStatistics.numShadowRays);
+                rayCount("Total rays", rayStatistics.GetNumRays());
+                rayCount("Refractions", rayStatistics.numRefractions);
+
+                // Every path ends exactly once, by escaping to the skybox, Russian roulette, or the bounce limit.
+                float numPaths = static_cast<float>(glm::max(rayStatistics.numPrimaryRays, 1u));
+
+                ImGui::Text("Average path length: %.2f rays", rayStatistics.GetAveragePathLength());
+                ImGui::Text("Sky misses: %u (%.1f%% of rays)", rayStatistics.numSkyMisses, rayStatistics.GetMissRatio() * 100.0f);
+                ImGui::Text("Roulette terminations: %u (%.1f%% of paths)", rayStatistics.numRouletteTerminations, static_cast<float>(rayStatistics.numRouletteTerminations) / numPaths * 100.0f);
+                ImGui::Text("Bounce limit terminations: %u (%.1f%% of paths)", rayStatistics.numBounceLimitTerminations, static_cast<float>(rayStatistics.numBounceLimitTerminations) / numPaths * 100.0f);
+
+                // Paths ending at every depth, up to the current bounce limit.
+                float pathDepths[OpenGL::RayStatistics::maxDepth];
+                int numDepths = glm::min(numRayBounces, OpenGL::RayStatistics::maxDepth);
+                for (int i = 0; i < numDepths; ++i) {
+                    pathDepths[i] = static_cast<float>(rayStatistics.pathDepths[i]);
+                }
+
+                ImGui::Text("Path depths:");
+                ImGui::PlotHistogram("##pathDepths", pathDepths, numDepths, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+            }
+
             static char outputFilename[256] = { "result" };
 
+            static std::string outputDirectory = "src/samples/path-tracing/data/screenshots/";
+
             if (ImGui::Button("Take Screenshot")) {
-                static std::string outputDirectory = "src/samples/path-tracing/data/screenshots/";
+                // Read in OpenGL texture data asynchronously, final output image is saved once the GPU has caught up.
+                if (!imageCapture.Capture(postProcessingFrame, width, height, outputDirectory + std::string(outputFilename))) {
+                    std::cerr << "Failed to take screenshot, too many captures are already in progress." << std::endl;
+                }
+            }
+
+            int numPendingCaptures = imageCapture.GetNumPendingCaptures();
+            if (numPendingCaptures > 0) {
+                ImGui::SameLine();
+                ImGui::Text("Saving (%i)...", numPendingCaptures);
+            }
 
-                if (!std::filesystem::exists(outputDirectory)) {
-                    // Create output directory if it doesn't exist.
-                    std::filesystem::create_directory(outputDirectory);
+            ImGui::Text("Filename:");
+            ImGui::InputText("##outputFilename", outputFilename, 256);
+
+            // Raw radiance of the accumulation buffer, before exposure / tonemapping, for re-exposing renders offline.
+            static int hdrFormat = static_cast<int>(OpenGL::HDRFormat::OpenEXRHalf);
+            ImGui::Text("HDR format:");
+            ImGui::Combo("##hdrFormat", &hdrFormat, "OpenEXR (half)\0OpenEXR (float)\0PFM\0Radiance (.hdr)\0");
+
+            if (ImGui::Button("Save HDR Image")) {
+                // Frame counter has already been advanced, the most recently accumulated frame is the 'previous' frame image.
+                GLuint accumulationImage = (inPlaceAccumulation || (frameCounter + 1) % 2 == 0) ? frame1 : frame2;
+
+                if (!imageCapture.CaptureHDR(accumulationImage, internalWidth, internalHeight, outputDirectory + std::string(outputFilename), static_cast<OpenGL::HDRFormat>(hdrFormat))) {
+                    std::cerr << "Failed to save HDR image, too many captures are already in progress." << std::endl;
                 }
+            }
+
+            ImGui::Separator();
 
-                // Save final output image.
-                int channels = 4;
-                std::vector<unsigned char> pixels(width * height * channels);
+            // Frame sequence / video recording.
+            static int recordingFormat = static_cast<int>(OpenGL::FrameRecorder::Format::PNGSequence);
+            static int overflowPolicy = static_cast<int>(OpenGL::FrameRecorder::OverflowPolicy::Block);
+            static int maxQueuedFrames = 8;
+            static int framesPerSecond = 30;
 
-                // Read in OpenGL texture data.
-                glBindTexture(GL_TEXTURE_2D, postProcessingFrame);
-                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-                glBindTexture(GL_TEXTURE_2D, 0);
+            ImGui::Text("Recording format:");
+            ImGui::Combo("##recordingFormat", &recordingFormat, "PNG sequence\0Y4M video\0");
 
-                stbi_flip_vertically_on_write(true);
-                stbi_write_png(std::string(outputDirectory + std::string(outputFilename) + ".png").c_str(), width, height, channels, pixels.data(), 0);
-                stbi_write_jpg(std::string(outputDirectory + std::string(outputFilename) + ".jpg").c_str(), width, height, channels, pixels.data(), 100);
+            ImGui::Text("Frames accumulated per recorded frame:");
+            if (ImGui::SliderInt("##framesPerRecordedFrame", &framesPerRecordedFrame, 1, 256)) {
+                // Manual input can go outside the valid range.
+                framesPerRecordedFrame = glm::clamp(framesPerRecordedFrame, 1, 256);
             }
+            ImGui::Text("(%i samples per pixel)", framesPerRecordedFrame * samplesPerPixel);
 
-            ImGui::Text("Filename:");
-            ImGui::InputText("##outputFilename", outputFilename, 256);
+            ImGui::Checkbox("Turntable?", &recordTurntable);
+            ImGui::Text("Turntable rotation per frame (degrees):");
+            if (ImGui::SliderFloat("##turntableDegreesPerFrame", &turntableDegreesPerFrame, 0.1f, 30.0f)) {
+                // Manual input can go outside the valid range.
+                turntableDegreesPerFrame = glm::clamp(turntableDegreesPerFrame, 0.1f, 30.0f);
+            }
+
+            ImGui::Text("Playback rate (FPS):");
+            if (ImGui::SliderInt("##framesPerSecond", &framesPerSecond, 1, 120)) {
+                // Manual input can go outside the valid range.
+                framesPerSecond = glm::clamp(framesPerSecond, 1, 120);
+            }
+
+            ImGui::Text("When the disk falls behind:");
+            ImGui::Combo("##overflowPolicy", &overflowPolicy, "Wait (back-pressure)\0Drop frames\0");
+
+            ImGui::Text("Maximum queued frames:");
+            if (ImGui::SliderInt("##maxQueuedFrames", &maxQueuedFrames, 1, 64)) {
+                // Manual input can go outside the valid range.
+                maxQueuedFrames = glm::clamp(maxQueuedFrames, 1, 64);
+            }
+
+            if (!frameRecorder.IsRecording()) {
+                if (ImGui::Button("Start Recording")) {
+                    static std::string recordingDirectory = "src/samples/path-tracing/data/recordings/";
+
+                    if (!frameRecorder.Start(recordingDirectory + std::string(outputFilename), static_cast<OpenGL::FrameRecorder::Format>(recordingFormat), width, height, framesPerSecond,
+                                             static_cast<OpenGL::FrameRecorder::OverflowPolicy>(overflowPolicy), static_cast<std::size_t>(maxQueuedFrames))) {
+                        std::cerr << "Failed to start recording." << std::endl;
+                    }
+
+                    // Every recorded frame starts from a clean accumulation buffer.
+                    refreshRenderTargets = true;
+                }
+            }
+            else {
+                if (ImGui::Button("Stop Recording")) {
+                    frameRecorder.Stop();
+                }
+            }
+
+            if (frameRecorder.IsRecording() || frameRecorder.GetNumFramesCaptured() > 0) {
+                ImGui::Text("Frames: %i captured, %i written, %i dropped", frameRecorder.GetNumFramesCaptured(), frameRecorder.GetNumFramesWritten(), frameRecorder.GetNumFramesDropped());
+                ImGui::Text("Pending: %i frames (at most %.1f MB)", frameRecorder.GetNumFramesPending(), static_cast<float>(frameRecorder.GetMaximumMemoryUsage()) / (1024.0f * 1024.0f));
+            }
 
             ImGui::PopStyleColor();
         }
@@ -936,6 +1210,185 @@ int main() {
                 }
             }
 
+            if (ImGui::Checkbox("Environment importance sampling?", &environmentImportanceSampling)) {
+                refreshRenderTargets = true;
+            }
+
+            if (ImGui::Checkbox("Prefiltered reflections?", &prefilteredReflections)) {
+                refreshRenderTargets = true;
+            }
+
+            ImGui::Text("Work group size:");
+            if (ImGui::Combo("##workGroupSize", &workGroupSizeIndex, "8x4\08x8\016x8\016x16\032x4\032x8\032x32\0")) {
+                // Work group dimensions are compile-time constants, recompile the path tracing shader.
+                // Results are identical, only the cost changes.
+                recompilePathTracingShader = true;
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Wavefront path tracing?", &wavefrontPathTracing)) {
+                // Stages are only compiled while wavefront path tracing is enabled.
+                recompilePathTracingShader = true;
+            }
+
+            if (wavefrontPathTracing) {
+                ImGui::Checkbox("Sort secondary rays?", &sortSecondaryRays);
+
+                std::size_t wavefrontMemory = wavefrontPathTracer ? wavefrontPathTracer->GetMemoryUsage() : 0;
+                ImGui::Text("Ray queue memory: %.1f MB", static_cast<float>(wavefrontMemory) / (1024.0f * 1024.0f));
+            }
+
+            if (simdStatisticsSupported) {
+                if (ImGui::Checkbox("Measure SIMD efficiency?", &measureSIMDEfficiency)) {
+                    // Statistics are gathered by the path tracing shader(s).
+                    recompilePathTracingShader = true;
+                }
+
+                if (measureSIMDEfficiency) {
+                    float milliseconds = pathTracingTimer.GetAverageMilliseconds();
+
+                    ImGui::Text("SIMD efficiency: %.1f%%", simdEfficiency * 100.0f);
+                    ImGui::Text("Bounce throughput: %.1f Mrays/s", milliseconds > 0.0f ? static_cast<float>(raysPerFrame) / (milliseconds * 1000.0f) : 0.0f);
+                }
+            }
+            else {
+                ImGui::Text("SIMD efficiency requires GL_ARB_shader_ballot.");
+            }
+
+            if (ImGui::Checkbox("Measure ray statistics?", &measureRayStatistics)) {
+                // Counters are compiled into the path tracing shader(s), and shown in the sample overview.
+                recompilePathTracingShader = true;
+            }
+
+            // Heatmaps replace the final image, and are saved by screenshots / recordings like it.
+            ImGui::Text("Debug view:");
+            const char* debugViews = shaderClockSupported ? "Off\0Intersection tests\0Bounces\0Rays traced\0Shader clock\0" : "Off\0Intersection tests\0Bounces\0Rays traced\0";
+            if (ImGui::Combo("##debugView", &debugView, debugViews)) {
+                // Accumulated radiance and cost can not be mixed.
+                recompilePathTracingShader = true;
+                refreshRenderTargets = true;
+            }
+
+            if (!shaderClockSupported) {
+                ImGui::Text("Shader clock view requires GL_ARB_shader_clock.");
+            }
+
+            if (debugView > 0) {
+                float& heatmapMaximum = heatmapMaximums[debugView];
+
+                ImGui::Text("Heatmap maximum (%s):", debugView == 4 ? "thousands of cycles per sample" : "per sample");
+                if (ImGui::DragFloat("##heatmapMaximum", &heatmapMaximum, heatmapMaximum * 0.01f, 1.0f, 1000000.0f)) {
+                    // Manual input can go outside the valid range.
+                    heatmapMaximum = glm::clamp(heatmapMaximum, 1.0f, 1000000.0f);
+                }
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Accumulate in place?", &inPlaceAccumulation)) {
+                reallocateAccumulationTargets = true;
+                recompilePathTracingShader = true;
+            }
+
+            ImGui::Text("Accumulation precision:");
+            if (ImGui::Combo("##accumulationPrecision", &accumulationPrecision, "RGBA32F\0RGBA16F + sample count\0")) {
+                reallocateAccumulationTargets = true;
+                recompilePathTracingShader = true;
+            }
+
+            ImGui::Text("Output precision:");
+            if (ImGui::Combo("##outputPrecision", &outputPrecision, "RGBA8\0RGB10_A2\0")) {
+                reallocateOutputTarget = true;
+            }
+
+            // Bytes per pixel at internal and window resolution.
+            std::size_t accumulationSize = static_cast<std::size_t>(accumulationFormatSizes[accumulationPrecision]) * (inPlaceAccumulation ? 1 : 2) + (accumulationPrecision == 1 ? 4 : 0);
+            std::size_t outputSize = 8 + 4; // Upscaled (RGBA16F), post-processed (RGBA8 / RGB10_A2).
+
+            std::size_t renderTargetMemory = accumulationSize * static_cast<std::size_t>(internalWidth) * static_cast<std::size_t>(internalHeight) +
+                                             outputSize * static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+            ImGui::Text("Render target memory: %.1f MB", static_cast<float>(renderTargetMemory) / (1024.0f * 1024.0f));
+            ImGui::Text("Skybox memory: %.1f MB (%s%s)", static_cast<float>(skybox->GetMemoryUsage()) / (1024.0f * 1024.0f),
+                        skybox->IsCompressed() ? "DXT1" : "RGB8", skybox->IsLoadedFromCache() ? ", cached" : "");
+
+            ImGui::Separator();
+
+            ImGui::Checkbox("Dynamic resolution?", &dynamicResolution);
+
+            if (dynamicResolution) {
+                ImGui::Text("Target path tracing time (ms):");
+                if (ImGui::SliderFloat("##targetPathTracingTime", &targetPathTracingTime, 4.0f, 200.0f)) {
+                    // Manual input can go outside the valid range.
+                    targetPathTracingTime = glm::clamp(targetPathTracingTime, 4.0f, 200.0f);
+                }
+
+                ImGui::Text("Minimum resolution scale:");
+                if (ImGui::SliderFloat("##minimumResolutionScale", &minimumResolutionScale, 0.1f, 1.0f)) {
+                    // Manual input can go outside the valid range.
+                    minimumResolutionScale = glm::clamp(minimumResolutionScale, 0.1f, 1.0f);
+                }
+
+                resolutionScale = glm::max(resolutionScale, minimumResolutionScale);
+            }
+            else {
+                ImGui::Text("Resolution scale:");
+                if (ImGui::SliderFloat("##resolutionScale", &resolutionScale, 0.1f, 1.0f)) {
+                    // Manual input can go outside the valid range.
+                    resolutionScale = glm::clamp(resolutionScale, 0.1f, 1.0f);
+                }
+            }
+
+            ImGui::Text("Upscale filter:");
+            ImGui::Combo("##upscaleFilter", &upscaleFilter, "Bilinear\0Edge-aware\0");
+
+            if (upscaleFilter == 1) {
+                ImGui::Text("Edge sharpness:");
+                if (ImGui::SliderFloat("##edgeSharpness", &edgeSharpness, 0.0f, 32.0f)) {
+                    // Manual input can go outside the valid range.
+                    edgeSharpness = glm::clamp(edgeSharpness, 0.0f, 32.0f);
+                }
+            }
+
+            ImGui::Text("Internal resolution: %i x %i (%.0f%%)", internalWidth, internalHeight, resolutionScale * 100.0f);
+            ImGui::Text("Path tracing GPU time: %.3f ms", pathTracingTimer.GetAverageMilliseconds());
+
+            ImGui::Separator();
+
+            if (ImGui::Checkbox("Tiled rendering?", &tiledRendering)) {
+                refreshRenderTargets = true;
+            }
+
+            if (tiledRendering) {
+                ImGui::Text("Tile size:");
+                int tempTileSize = tileSize;
+                if (ImGui::SliderInt("##tileSize", &tempTileSize, 16, 512)) {
+                    // Manual input can go outside the valid range.
+                    tempTileSize = glm::clamp(tempTileSize, 16, 512);
+
+                    if (tempTileSize != tileSize) {
+                        tileSize = tempTileSize;
+                        tileTimer.Reset();
+                        refreshRenderTargets = true;
+                    }
+                }
+
+                ImGui::Text("Tile order:");
+                ImGui::Combo("##tileOrder", &tileOrder, "Morton (Z-order)\0Spiral from cursor\0");
+
+                ImGui::Text("GPU time budget per frame (ms):");
+                if (ImGui::SliderFloat("##tileTimeBudget", &tileTimeBudget, 1.0f, 100.0f)) {
+                    // Manual input can go outside the valid range.
+                    tileTimeBudget = glm::clamp(tileTimeBudget, 1.0f, 100.0f);
+                }
+
+                ImGui::Text("GPU time per tile: %.3f ms (%i tiles per frame)", tileTimer.GetAverageMilliseconds(), tilesPerFrame);
+
+                int numTiles = numTilesX * numTilesY;
+                std::string progress = std::to_string(nextTile) + " / " + std::to_string(numTiles) + " tiles";
+                ImGui::ProgressBar(numTiles > 0 ? static_cast<float>(nextTile) / static_cast<float>(numTiles) : 0.0f, ImVec2(-1.0f, 0.0f), progress.c_str());
+            }
+
             ImGui::PopStyleColor();
         }
         ImGui::End();
@@ -986,85 +1439,379 @@ int main() {
         }
         ImGui::End();
 
-        pathTracingShader.Bind();
+        // Apply changes to the render target configuration before anything gets rendered with it.
+        int tempInternalWidth = glm::max(static_cast<int>(static_cast<float>(width) * resolutionScale), 1);
+        int tempInternalHeight = glm::max(static_cast<int>(static_cast<float>(height) * resolutionScale), 1);
+
+        if (tempInternalWidth != internalWidth || tempInternalHeight != internalHeight || reallocateAccumulationTargets) {
+            // Internal resolution (or accumulation format) changed, accumulated samples no longer map to pixels.
+            internalWidth = tempInternalWidth;
+            internalHeight = tempInternalHeight;
+
+            createAccumulationTargets();
+
+            // Timings still in flight were measured at the previous resolution.
+            pathTracingTimer.Reset();
+            tileTimer.Reset();
+            refreshRenderTargets = true;
+            reallocateAccumulationTargets = false;
+
+            numTilesX = (internalWidth + tileSize - 1) / tileSize;
+            numTilesY = (internalHeight + tileSize - 1) / tileSize;
+        }
+
+        if (recompilePathTracingShader) {
+            pathTracingShader = createPathTracingShader();
+
+            if (wavefrontPathTracing) {
+                wavefrontPathTracer = std::make_unique<OpenGL::WavefrontPathTracer>(getPathTracingDefines());
+            }
+            else {
+                wavefrontPathTracer.reset();
+            }
 
-        pathTracingShader.SetUniform("frameCounter", frameCounter);
-        pathTracingShader.SetUniform("samplesPerPixel", samplesPerPixel);
-        pathTracingShader.SetUniform("numRayBounces", numRayBounces);
-        pathTracingShader.SetUniform("focusDistance", focusDistance);
-        pathTracingShader.SetUniform("apertureRadius", apertureRadius);
+            pathTracingTimer.Reset();
+            tileTimer.Reset();
+            recompilePathTracingShader = false;
+        }
+
+        if (reallocateOutputTarget) {
+            if (!createOutputTargets()) {
+                std::cerr << "Failed to reinitialize custom output framebuffer on output format change." << std::endl;
+                break;
+            }
+
+            postProcessingShader = createPostProcessingShader();
+            reallocateOutputTarget = false;
+        }
+
+        // Ray queues hold a ray for every pixel of the internal resolution image.
+        if (wavefrontPathTracer) {
+            wavefrontPathTracer->Reserve(static_cast<std::size_t>(internalWidth) * static_cast<std::size_t>(internalHeight));
+        }
 
         int previousFrameIndex = (frameCounter + 1) % 2;
         int currentFrameIndex = (frameCounter % 2);
 
-        GLuint previousFrameImage = previousFrameIndex == 0 ? frame1 : frame2;
-        GLuint currentFrameImage = currentFrameIndex == 0 ? frame1 : frame2;
+        GLuint previousFrameImage = (inPlaceAccumulation || previousFrameIndex == 0) ? frame1 : frame2;
+        GLuint currentFrameImage = (inPlaceAccumulation || currentFrameIndex == 0) ? frame1 : frame2;
 
         // For the best visual clarity, de-noising textures need to be reset when anything in the scene configuration changes.
         if (refreshRenderTargets) {
-            glBindTexture(GL_TEXTURE_2D, previousFrameImage);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, blankTexture.data());
-            glBindTexture(GL_TEXTURE_2D, 0);
+            clearAccumulationTargets(previousFrameImage);
 
             frameCounter = 0;
+
+            // Restart the pass.
+            numTilesX = (internalWidth + tileSize - 1) / tileSize;
+            numTilesY = (internalHeight + tileSize - 1) / tileSize;
+            nextTile = 0;
         }
 
+        // Determine the processing order of tiles at the start of every pass.
+        if (tiledRendering && nextTile == 0) {
+            tiles.clear();
 
+            for (int y = 0; y < numTilesY; ++y) {
+                for (int x = 0; x < numTilesX; ++x) {
+                    tiles.emplace_back(x, y);
+                }
+            }
 
-        // Render to intermediate textures.
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            if (tileOrder == 0) {
+                // Morton order keeps consecutive tiles spatially coherent.
+                std::sort(tiles.begin(), tiles.end(), [](const glm::ivec2& a, const glm::ivec2& b) -> bool {
+                    return Utilities::EncodeMorton2D(a.x, a.y) < Utilities::EncodeMorton2D(b.x, b.y);
+                });
+            }
+            else {
+                // Spiral outwards from the tile underneath the cursor, ring by ring.
+                glm::dvec2 cursorPosition;
+                glfwGetCursorPos(window, &cursorPosition.x, &cursorPosition.y);
+
+                // GLFW has (0, 0) in the top left, while OpenGL has (0, 0) in the bottom left.
+                glm::vec2 center = glm::vec2(static_cast<float>(cursorPosition.x) / static_cast<float>(width) * static_cast<float>(internalWidth),
+                                             (1.0f - static_cast<float>(cursorPosition.y) / static_cast<float>(height)) * static_cast<float>(internalHeight)) / static_cast<float>(tileSize);
+                glm::ivec2 centerTile = glm::clamp(glm::ivec2(glm::floor(center)), glm::ivec2(0), glm::ivec2(numTilesX - 1, numTilesY - 1));
+
+                std::sort(tiles.begin(), tiles.end(), [centerTile](const glm::ivec2& a, const glm::ivec2& b) -> bool {
+                    glm::ivec2 da = a - centerTile;
+                    glm::ivec2 db = b - centerTile;
+
+                    int ringA = glm::max(glm::abs(da.x), glm::abs(da.y));
+                    int ringB = glm::max(glm::abs(db.x), glm::abs(db.y));
 
+                    if (ringA != ringB) {
+                        return ringA < ringB;
+                    }
+
+                    // Within a ring, order by angle around the center.
+                    return glm::atan(static_cast<float>(da.y), static_cast<float>(da.x)) < glm::atan(static_cast<float>(db.y), static_cast<float>(db.x));
+                });
+            }
+        }
+
+
+
+        // Render to intermediate textures.
         // Determine which texture is the previous frame and which texture is the current frame.
-        // Previous frame is readonly for de-noising, current frame will be copied into the default framebuffer for rendering.
+        // Previous frame is readonly for de-noising, current frame receives the updated accumulation.
+        // With in-place accumulation both are the same image.
+        GLenum accumulationFormat = accumulationFormats[accumulationPrecision];
+
         glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, previousFrameImage, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        pathTracingShader.SetUniform("previousFrameImage", 0);
+        if (inPlaceAccumulation) {
+            glBindImageTexture(0, currentFrameImage, 0, GL_FALSE, 0, GL_READ_WRITE, accumulationFormat);
+        }
+        else {
+            glBindImageTexture(0, previousFrameImage, 0, GL_FALSE, 0, GL_READ_ONLY, accumulationFormat);
+            glBindImageTexture(1, currentFrameImage, 0, GL_FALSE, 0, GL_WRITE_ONLY, accumulationFormat);
+        }
+
+        if (accumulationPrecision == 1) {
+            glBindImageTexture(2, sampleCountFrame, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+        }
 
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skybox);
-        pathTracingShader.SetUniform("skyboxTexture", 1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->GetTexture());
 
-        drawBuffers[0] = GL_COLOR_ATTACHMENT0 + currentFrameIndex;
-        glDrawBuffers(1, drawBuffers.data());
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilteredSkybox->GetTexture());
 
-        // Render to FBO attachment.
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
-        pathTracingShader.Unbind();
+        auto setPathTracingUniforms = [&](OpenGL::Shader& shader) {
+            shader.Bind();
 
+            shader.SetUniform("frameCounter", frameCounter);
+            shader.SetUniform("samplesPerPixel", samplesPerPixel);
+            shader.SetUniform("numRayBounces", numRayBounces);
+            shader.SetUniform("focusDistance", focusDistance);
+            shader.SetUniform("apertureRadius", apertureRadius);
+            shader.SetUniform("environmentImportanceSampling", environmentImportanceSampling);
+            shader.SetUniform("prefilteredReflections", prefilteredReflections);
 
+            if (inPlaceAccumulation) {
+                shader.SetUniform("accumulationImage", 0);
+            }
+            else {
+                shader.SetUniform("previousFrameImage", 0);
+                shader.SetUniform("currentFrameImage", 1);
+            }
 
-        // Render to final texture.
-        postProcessingShader.Bind();
+            if (accumulationPrecision == 1) {
+                shader.SetUniform("sampleCountImage", 2);
+            }
+
+            shader.SetUniform("skyboxTexture", 1);
+            shader.SetUniform("prefilteredSkyboxTexture", 2);
+        };
+
+        if (wavefrontPathTracer) {
+            setPathTracingUniforms(wavefrontPathTracer->GetGenerateShader());
+            setPathTracingUniforms(wavefrontPathTracer->GetExtendShader());
+            setPathTracingUniforms(wavefrontPathTracer->GetResolveShader());
+        }
+        else {
+            setPathTracingUniforms(*pathTracingShader);
+        }
+
+        // Path traces a region of the internal resolution image.
+        // Every invocation writes exactly one pixel, dispatches are rounded up to whole work groups.
+        const glm::ivec2& workGroupSize = workGroupSizes[workGroupSizeIndex];
+
+        auto dispatchPathTracing = [&](const glm::ivec2& offset, const glm::ivec2& size) {
+            if (wavefrontPathTracer) {
+                wavefrontPathTracer->Dispatch(offset, size, samplesPerPixel, numRayBounces, sortSecondaryRays, scene.GetMinimum(), scene.GetMaximum());
+                return;
+            }
+
+            pathTracingShader->SetUniform("regionOffset", offset);
+            pathTracingShader->SetUniform("regionSize", size);
+
+            glm::ivec2 numWorkGroups = (size + workGroupSize - 1) / workGroupSize;
+            glDispatchCompute(numWorkGroups.x, numWorkGroups.y, 1);
+        };
+
+        bool passCompleted = true;
+        GLuint latestFrameImage = currentFrameImage;
+
+        if (measureSIMDEfficiency) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, simdStatisticsBuffer);
+            glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+        if (measureRayStatistics) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayStatisticsBuffer);
+            glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+        pathTracingTimer.Begin();
+
+        if (tiledRendering) {
+            // Fit as many tiles as possible into the time budget, based on the average time per tile.
+            float timePerTile = tileTimer.GetAverageMilliseconds();
+            if (tileTimer.GetNumMeasurements() > 0 && timePerTile > 0.0f) {
+                tilesPerFrame = static_cast<int>(tileTimeBudget / timePerTile);
+            }
+            tilesPerFrame = glm::clamp(tilesPerFrame, 1, static_cast<int>(tiles.size()));
+
+            int lastTile = glm::min(nextTile + tilesPerFrame, static_cast<int>(tiles.size()));
+
+            for (int i = nextTile; i < lastTile; ++i) {
+                glm::ivec2 offset = tiles[i] * tileSize;
+                glm::ivec2 size = glm::min(glm::ivec2(tileSize), glm::ivec2(internalWidth, internalHeight) - offset);
+
+                if (i == nextTile) {
+                    tileTimer.Begin();
+                }
+
+                dispatchPathTracing(offset, size);
+
+                if (i == nextTile) {
+                    tileTimer.End();
+                }
+
+                // Every pixel only reads its own accumulated value from the previous frame, so finished tiles can be copied
+                // back into the previous frame image. The previous frame image then always holds the latest result, which
+                // is what gets displayed while the pass is still in progress.
+                // In-place accumulation always holds the latest result.
+                if (!inPlaceAccumulation) {
+                    // The tile was written with image stores, which no narrower barrier bit covers for image copies.
+                    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+                    glCopyImageSubData(currentFrameImage, GL_TEXTURE_2D, 0, offset.x, offset.y, 0,
+                                       previousFrameImage, GL_TEXTURE_2D, 0, offset.x, offset.y, 0,
+                                       size.x, size.y, 1);
+                }
+            }
+
+            // Outline the tiles path traced this frame, unless the whole pass fits into a single frame.
+            if (tilesPerFrame < static_cast<int>(tiles.size())) {
+                ImDrawList* drawList = ImGui::GetForegroundDrawList();
+                glm::vec2 scale = glm::vec2(io.DisplaySize.x, io.DisplaySize.y) / glm::vec2(internalWidth, internalHeight);
+
+                for (int i = nextTile; i < lastTile; ++i) {
+                    glm::vec2 minimum = glm::vec2(tiles[i] * tileSize) * scale;
+                    glm::vec2 maximum = glm::min(glm::vec2((tiles[i] + 1) * tileSize), glm::vec2(internalWidth, internalHeight)) * scale;
+
+                    // ImGui has (0, 0) in the top left, while OpenGL has (0, 0) in the bottom left.
+                    drawList->AddRect(ImVec2(minimum.x, io.DisplaySize.y - maximum.y), ImVec2(maximum.x, io.DisplaySize.y - minimum.y), 0x80ffffff);
+                }
+            }
+
+            nextTile = lastTile;
+            passCompleted = nextTile == static_cast<int>(tiles.size());
+            latestFrameImage = previousFrameImage;
+
+            if (passCompleted) {
+                nextTile = 0;
+            }
+        }
+        else {
+            dispatchPathTracing(glm::ivec2(0), glm::ivec2(internalWidth, internalHeight));
+        }
+
+        pathTracingTimer.End();
+
+        pathTracingShader->Unbind();
+
+        // Statistics of this frame are skipped while the readbacks of earlier frames are all still in flight.
+        if (measureSIMDEfficiency && !simdStatisticsReadback.IsBusy()) {
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+            if (!simdStatisticsReadback.ReadBuffer(simdStatisticsBuffer, 0, 3 * sizeof(GLuint), [&simdEfficiency, &raysPerFrame](std::vector<unsigned char> data) {
+                GLuint statistics[3];
+                std::memcpy(statistics, data.data(), sizeof(statistics));
+
+                simdEfficiency = (statistics[1] > 0) ? static_cast<float>(statistics[0]) / static_cast<float>(statistics[1]) : 0.0f;
+                raysPerFrame = statistics[2];
+            })) {
+                std::cerr << "Failed to read back SIMD statistics." << std::endl;
+            }
+        }
+
+        if (measureRayStatistics && !rayStatisticsReadback.IsBusy()) {
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+            // Rates per second are based on the most recent frame time, at the time the statistics were gathered.
+            float frameTime = dt;
+
+            if (!rayStatisticsReadback.ReadBuffer(rayStatisticsBuffer, 0, sizeof(OpenGL::RayStatistics), [&rayStatistics, &rayStatisticsFrameTime, frameTime](std::vector<unsigned char> data) {
+                std::memcpy(&rayStatistics, data.data(), sizeof(OpenGL::RayStatistics));
+                rayStatisticsFrameTime = frameTime;
+            })) {
+                std::cerr << "Failed to read back ray statistics." << std::endl;
+            }
+        }
+
+        // Accumulation images are sampled by the upscale pass, loaded by the next frame and possibly read back (HDR export).
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+
+
+        // Upscale accumulated image to window resolution.
+        upscaleShader.Bind();
 
         glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, currentFrameImage, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        postProcessingShader.SetUniform("finalImage", 0);
+        glBindTexture(GL_TEXTURE_2D, latestFrameImage);
+        upscaleShader.SetUniform("inputImage", 0);
 
-        postProcessingShader.SetUniform("exposure", exposure);
+        glBindImageTexture(0, upscaledFrame, 0, GL_FALSE, 0, GL_WRITE_ONLY, upscaledFormat);
+        upscaleShader.SetUniform("outputImage", 0);
 
-        drawBuffers[0] = GL_COLOR_ATTACHMENT2; // Color attachment 2 is always the render target for final output.
-        glDrawBuffers(1, drawBuffers.data());
+        upscaleShader.SetUniform("filterMode", upscaleFilter);
+        upscaleShader.SetUniform("edgeSharpness", edgeSharpness);
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
+        glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1); // 8x8 work groups.
 
-        postProcessingShader.Unbind();
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        upscaleShader.Unbind();
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+
+
+        // Render to final texture.
+        postProcessingShader->Bind();
+
+        glBindImageTexture(0, upscaledFrame, 0, GL_FALSE, 0, GL_READ_ONLY, upscaledFormat);
+        postProcessingShader->SetUniform("finalImage", 0);
+
+        glBindImageTexture(1, postProcessingFrame, 0, GL_FALSE, 0, GL_WRITE_ONLY, outputFormats[outputPrecision]);
+        postProcessingShader->SetUniform("outputImage", 1);
+
+        postProcessingShader->SetUniform("exposure", exposure);
+        postProcessingShader->SetUniform("heatmap", debugView > 0);
+        postProcessingShader->SetUniform("heatmapMaximum", heatmapMaximums[debugView]);
+
+        glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1); // 8x8 work groups.
+
+        postProcessingShader->Unbind();
+
+        // Final output is blitted to the screen and possibly read back (screenshots, recording).
+        glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+        // Capture the recorded frame once it has accumulated the requested number of samples.
+        if (frameRecorder.IsRecording() && passCompleted && frameCounter + 1 >= framesPerRecordedFrame) {
+            frameRecorder.Capture(postProcessingFrame, width, height);
+            recordedFrameCaptured = true;
+        }
 
 
 
         // Render final output to screen.
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
-        glNamedFramebufferReadBuffer(fbo, GL_COLOR_ATTACHMENT2); // Set the read buffer to be the render attachment of the final output.
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFBO);
+        glNamedFramebufferReadBuffer(outputFBO, GL_COLOR_ATTACHMENT0); // Set the read buffer to be the render attachment of the final output.
 
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
+        // Output is stretched over the window while a resize is pending.
+        GLenum blitFilter = (tempWidth == width && tempHeight == height) ? GL_NEAREST : GL_LINEAR;
         glBlitFramebuffer(0, 0, width, height,
-                          0, 0, width, height,
-                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                          0, 0, tempWidth, tempHeight,
+                          GL_COLOR_BUFFER_BIT, blitFilter);
 
 
 
@@ -1081,7 +1828,10 @@ int main() {
 
         glfwSwapBuffers(window);
 
-        ++frameCounter %= INT_MAX;
+        // Frame counter only advances once every pixel has been path traced for this frame.
+        if (passCompleted) {
+            ++frameCounter %= INT_MAX;
+        }
 
         current = (float)glfwGetTime();
         dt = current - previous;
@@ -1089,18 +1839,21 @@ int main() {
     }
 
     // Shutdown.
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &ebo);
-    glDeleteBuffers(1, &uvVBO);
-    glDeleteBuffers(1, &verticesVBO);
-    glDeleteBuffers(1, &ssbo);
+    imageCapture.Flush();
+    frameRecorder.Stop();
+
+    glDeleteBuffers(1, &rayStatisticsBuffer);
+    glDeleteBuffers(1, &simdStatisticsBuffer);
     glDeleteBuffers(1, &ubo);
-    glDeleteFramebuffers(1, &fbo);
-    glDeleteRenderbuffers(1, &rbo);
+    glDeleteFramebuffers(1, &outputFBO);
     glDeleteTextures(1, &postProcessingFrame);
+    glDeleteTextures(1, &upscaledFrame);
+    glDeleteTextures(1, &sampleCountFrame);
     glDeleteTextures(1, &frame2);
     glDeleteTextures(1, &frame1);
-    glDeleteTextures(1, &skybox);
+    wavefrontPathTracer.reset();
+    prefilteredSkybox.reset();
+    skybox.reset();
 
     ImGui::SaveIniSettingsToDisk(imGuiIni.c_str());
     ImGui_ImplOpenGL3_Shutdown();
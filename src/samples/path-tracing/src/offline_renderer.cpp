@@ -0,0 +1,277 @@
+
+#include "pch.h"
+#include "offline_renderer.h"
+
+namespace OpenGL {
+
+    OfflineRenderer::OfflineRenderer(int width, int height, int numRayBounces) : width_(width),
+                                                                                 height_(height),
+                                                                                 numRayBounces_(numRayBounces),
+                                                                                 integrator_(Integrator::Megakernel),
+                                                                                 camera_(width, height),
+                                                                                 focusDistance_(0.0f),
+                                                                                 apertureRadius_(0.2f),
+                                                                                 ubo_(0),
+                                                                                 accumulationImage_(0),
+                                                                                 upscaledImage_(0),
+                                                                                 outputImage_(0) {
+        // Same viewpoint (and depth of field) as the interactive renderer starts with.
+        camera_.SetPosition(glm::vec3(0.0f, 0.0f, 25.0f));
+        focusDistance_ = glm::max(glm::distance(camera_.GetPosition(), glm::vec3(0.0f)), 10.0f);
+
+        // Inverse camera transforms (2x mat4), camera position (vec3, vec4 with padding).
+        glGenBuffers(1, &ubo_);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2 + sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        UploadCamera();
+
+        // Skybox is loaded from the cache written by the interactive renderer (or decoded and cached, on the first launch).
+        std::vector<std::string> textureFaces = {
+            "src/samples/path-tracing/assets/textures/skybox/water/pos_x.jpg",
+            "src/samples/path-tracing/assets/textures/skybox/water/neg_x.jpg",
+            "src/samples/path-tracing/assets/textures/skybox/water/pos_y.jpg",
+            "src/samples/path-tracing/assets/textures/skybox/water/neg_y.jpg",
+            "src/samples/path-tracing/assets/textures/skybox/water/pos_z.jpg",
+            "src/samples/path-tracing/assets/textures/skybox/water/neg_z.jpg"
+        };
+
+        skybox_ = std::make_unique<Cubemap>(textureFaces, "src/samples/path-tracing/data/cache/");
+        environmentDistribution_ = std::make_unique<EnvironmentDistribution>(*skybox_);
+
+        glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+        {
+            Shader prefilterShader { "Prefilter Environment", { "src/samples/path-tracing/assets/shaders/prefilter_environment.comp" } };
+            prefilteredSkybox_ = std::make_unique<PrefilteredEnvironment>(*skybox_, prefilterShader);
+        }
+
+        scene_ = std::make_unique<Scene>();
+
+        // Full precision, in-place accumulation.
+        pathTracingShader_ = std::make_unique<Shader>("Path Tracing", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/path_tracing.comp" },
+                                                      std::vector<Shader::ShaderDefine> { { "ACCUMULATION_FORMAT", "rgba32f" },
+                                                                                          { "IN_PLACE_ACCUMULATION", "1" } });
+
+        upscaleShader_ = std::make_unique<Shader>("Upscale", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/upscale.comp" });
+        postProcessingShader_ = std::make_unique<Shader>("Post Processing", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/post_processing.comp" });
+
+        // Accumulation image is sampled by the upscale pass.
+        auto createImage = [this](GLuint& texture, GLenum format, GLenum filter) {
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexStorage2D(GL_TEXTURE_2D, 1, format, width_, height_);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        };
+
+        createImage(accumulationImage_, GL_RGBA32F, GL_LINEAR);
+        createImage(upscaledImage_, GL_RGBA16F, GL_NEAREST);
+        createImage(outputImage_, GL_RGBA8, GL_NEAREST);
+    }
+
+    OfflineRenderer::~OfflineRenderer() {
+        glDeleteTextures(1, &outputImage_);
+        glDeleteTextures(1, &upscaledImage_);
+        glDeleteTextures(1, &accumulationImage_);
+        glDeleteBuffers(1, &ubo_);
+    }
+
+    std::vector<float> OfflineRenderer::Render(const glm::ivec2& offset, const glm::ivec2& size, int firstSample, int numSamples) {
+        // A null pointer clears to zero, which restarts accumulation (see Accumulate in path_tracing.comp).
+        glClearTexSubImage(accumulationImage_, 0, offset.x, offset.y, 0, size.x, size.y, 1, GL_RGBA, GL_FLOAT, nullptr);
+
+        // Bindings may have been changed by other users of the context.
+        glBindBufferBase(GL_UNIFORM_BUFFER, 0, ubo_); // Binding 0.
+        scene_->Bind();
+        environmentDistribution_->Bind(2); // Binding 2.
+
+        glBindImageTexture(0, accumulationImage_, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, skybox_->GetTexture());
+
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilteredSkybox_->GetTexture());
+
+        // Every stage of the wavefront integrator uses the same uniforms as the megakernel.
+        std::vector<Shader*> shaders;
+        if (integrator_ == Integrator::Megakernel) {
+            shaders = { pathTracingShader_.get() };
+        }
+        else {
+            shaders = { &wavefrontPathTracer_->GetGenerateShader(), &wavefrontPathTracer_->GetExtendShader(), &wavefrontPathTracer_->GetResolveShader() };
+            wavefrontPathTracer_->Reserve(static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y));
+        }
+
+        for (Shader* shader : shaders) {
+            shader->Bind();
+
+            shader->SetUniform("samplesPerPixel", 1);
+            shader->SetUniform("numRayBounces", numRayBounces_);
+            shader->SetUniform("focusDistance", focusDistance_);
+            shader->SetUniform("apertureRadius", apertureRadius_);
+            shader->SetUniform("environmentImportanceSampling", true);
+            shader->SetUniform("prefilteredReflections", true);
+            shader->SetUniform("accumulationImage", 0);
+            shader->SetUniform("skyboxTexture", 1);
+            shader->SetUniform("prefilteredSkyboxTexture", 2);
+            shader->SetUniform("regionOffset", offset);
+            shader->SetUniform("regionSize", size);
+        }
+
+        glm::ivec3 workGroupSize = pathTracingShader_->GetWorkGroupSize();
+        glm::ivec2 numWorkGroups((size.x + workGroupSize.x - 1) / workGroupSize.x, (size.y + workGroupSize.y - 1) / workGroupSize.y);
+
+        renderTimer_.Begin();
+
+        for (int sample = firstSample; sample < firstSample + numSamples; ++sample) {
+            for (Shader* stage : shaders) {
+                stage->Bind();
+                stage->SetUniform("frameCounter", sample);
+            }
+
+            if (integrator_ == Integrator::Megakernel) {
+                glDispatchCompute(numWorkGroups.x, numWorkGroups.y, 1);
+            }
+            else {
+                wavefrontPathTracer_->Dispatch(offset, size, 1, numRayBounces_, integrator_ == Integrator::WavefrontSorted, scene_->GetMinimum(), scene_->GetMaximum());
+            }
+
+            // Every dispatch blends into the result of the previous one.
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+            // Keep individual submissions short.
+            glFlush();
+        }
+
+        renderTimer_.End();
+
+        pathTracingShader_->Unbind();
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+        std::vector<float> radiance(static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * 3);
+        glGetTextureSubImage(accumulationImage_, 0, offset.x, offset.y, 0, size.x, size.y, 1, GL_RGB, GL_FLOAT, static_cast<GLsizei>(radiance.size() * sizeof(float)), radiance.data());
+
+        // Rendering is finished after the readback, the timestamps only need to become available.
+        glFinish();
+        renderTimer_.Update();
+
+        return radiance;
+    }
+
+    float OfflineRenderer::GetRenderMilliseconds() const {
+        return renderTimer_.GetElapsedMilliseconds();
+    }
+
+    std::vector<float> OfflineRenderer::PostProcess(float exposure) {
+        glm::ivec2 numWorkGroups((width_ + 7) / 8, (height_ + 7) / 8); // 8x8 work groups.
+
+        // Edge-aware filter, at a scale of 1 the filter reduces to copying every texel.
+        upscaleShader_->Bind();
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, accumulationImage_);
+        upscaleShader_->SetUniform("inputImage", 0);
+
+        glBindImageTexture(0, upscaledImage_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        upscaleShader_->SetUniform("outputImage", 0);
+
+        upscaleShader_->SetUniform("filterMode", 1);
+        upscaleShader_->SetUniform("edgeSharpness", 8.0f);
+
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        glDispatchCompute(numWorkGroups.x, numWorkGroups.y, 1);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        upscaleShader_->Unbind();
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        postProcessingShader_->Bind();
+
+        glBindImageTexture(0, upscaledImage_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+        postProcessingShader_->SetUniform("finalImage", 0);
+
+        glBindImageTexture(1, outputImage_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+        postProcessingShader_->SetUniform("outputImage", 1);
+
+        postProcessingShader_->SetUniform("exposure", exposure);
+
+        glDispatchCompute(numWorkGroups.x, numWorkGroups.y, 1);
+
+        postProcessingShader_->Unbind();
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+        std::vector<float> output(static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * 3);
+        glGetTextureImage(outputImage_, 0, GL_RGB, GL_FLOAT, static_cast<GLsizei>(output.size() * sizeof(float)), output.data());
+
+        return output;
+    }
+
+    void OfflineRenderer::SetCamera(const glm::vec3& position, const glm::vec3& target) {
+        camera_.SetPosition(position);
+        camera_.SetTargetPosition(target);
+        focusDistance_ = glm::distance(position, target);
+
+        UploadCamera();
+    }
+
+    void OfflineRenderer::SetNumRayBounces(int numRayBounces) {
+        numRayBounces_ = numRayBounces;
+    }
+
+    void OfflineRenderer::SetIntegrator(Integrator integrator) {
+        if (integrator != Integrator::Megakernel && !wavefrontPathTracer_) {
+            wavefrontPathTracer_ = std::make_unique<WavefrontPathTracer>(std::vector<Shader::ShaderDefine> { { "ACCUMULATION_FORMAT", "rgba32f" },
+                                                                                                             { "IN_PLACE_ACCUMULATION", "1" } });
+        }
+
+        integrator_ = integrator;
+    }
+
+    void OfflineRenderer::SetScene(std::unique_ptr<Scene> scene) {
+        scene_ = std::move(scene);
+    }
+
+    Scene& OfflineRenderer::GetScene() {
+        return *scene_;
+    }
+
+    std::size_t OfflineRenderer::GetMemoryUsage() const {
+        // RGBA32F accumulation, RGBA16F upscaled, RGBA8 output.
+        std::size_t numPixels = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_);
+        std::size_t memory = numPixels * (16 + 8 + 4);
+
+        // The wavefront buffers are kept around when switching back to the megakernel, but are not used by it.
+        if (wavefrontPathTracer_ && integrator_ != Integrator::Megakernel) {
+            memory += wavefrontPathTracer_->GetMemoryUsage();
+        }
+
+        return memory;
+    }
+
+    void OfflineRenderer::UploadCamera() {
+        glm::mat4 inverseProjectionMatrix = glm::inverse(camera_.GetPerspectiveTransform());
+        glm::mat4 inverseViewMatrix = glm::inverse(camera_.GetViewTransform());
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(inverseProjectionMatrix));
+        glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(inverseViewMatrix));
+        glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 2, sizeof(glm::vec3), glm::value_ptr(camera_.GetPosition()));
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    int OfflineRenderer::GetWidth() const {
+        return width_;
+    }
+
+    int OfflineRenderer::GetHeight() const {
+        return height_;
+    }
+
+}
@@ -0,0 +1,71 @@
+
+#include "pch.h"
+#include "prefiltered_environment.h"
+
+namespace OpenGL {
+
+    PrefilteredEnvironment::PrefilteredEnvironment(const Cubemap& environment, Shader& prefilterShader, int size, int numLevels, int numSamples) : texture_(0),
+                                                                                                                                               size_(std::min(size, environment.GetSize())),
+                                                                                                                                               numLevels_(numLevels) {
+        // Levels can not be smaller than a single texel.
+        int maximumNumLevels = 1;
+        while ((size_ >> maximumNumLevels) > 0) {
+            ++maximumNumLevels;
+        }
+        numLevels_ = glm::clamp(numLevels_, 1, maximumNumLevels);
+
+        glGenTextures(1, &texture_);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture_);
+        glTexStorage2D(GL_TEXTURE_CUBE_MAP, numLevels_, GL_RGBA16F, size_, size_);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        prefilterShader.Bind();
+        prefilterShader.SetUniform("numSamples", numSamples);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, environment.GetTexture());
+        prefilterShader.SetUniform("environmentTexture", 0);
+        prefilterShader.SetUniform("outputImage", 0);
+
+        glm::ivec3 workGroupSize = prefilterShader.GetWorkGroupSize();
+
+        for (int level = 0; level < numLevels_; ++level) {
+            int levelSize = std::max(size_ >> level, 1);
+            float roughness = numLevels_ > 1 ? static_cast<float>(level) / static_cast<float>(numLevels_ - 1) : 0.0f;
+
+            // All six faces of the level are bound as layers.
+            glBindImageTexture(0, texture_, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+            prefilterShader.SetUniform("roughness", roughness);
+
+            glDispatchCompute((levelSize + workGroupSize.x - 1) / workGroupSize.x, (levelSize + workGroupSize.y - 1) / workGroupSize.y, 6);
+        }
+
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        prefilterShader.Unbind();
+    }
+
+    PrefilteredEnvironment::~PrefilteredEnvironment() {
+        glDeleteTextures(1, &texture_);
+    }
+
+    GLuint PrefilteredEnvironment::GetTexture() const {
+        return texture_;
+    }
+
+    int PrefilteredEnvironment::GetSize() const {
+        return size_;
+    }
+
+    int PrefilteredEnvironment::GetNumLevels() const {
+        return numLevels_;
+    }
+
+}
@@ -48,6 +48,40 @@ namespace OpenGL {
         return updated | material.OnImGui();
     }
 
+    bool Sphere::Intersects(const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax) const {
+        glm::vec3 sphereToRayOrigin = origin - position;
+
+        // https://antongerdelan.net/opengl/raycasting.html
+        float b = glm::dot(direction, sphereToRayOrigin);
+        float c = glm::dot(sphereToRayOrigin, sphereToRayOrigin) - (radius * radius);
+
+        float discriminant = b * b - c;
+        if (discriminant < 0.0f) {
+            // No real roots, no intersection.
+            return false;
+        }
+
+        float sqrtDiscriminant = glm::sqrt(discriminant);
+
+        float t1 = -b - sqrtDiscriminant;
+        float t2 = -b + sqrtDiscriminant;
+
+        if (t2 < 0.0f) {
+            // Ray exited behind the origin (sphere is behind the camera).
+            return false;
+        }
+
+        // Bounds check.
+        float t = t1 < 0.0f ? t2 : t1;
+        if (t < tMin || t > tMax) {
+            // Closer intersection has already been found.
+            return false;
+        }
+
+        tMax = t;
+        return true;
+    }
+
 
 
     AABB::AABB() : position(glm::vec4(0.0f)),
@@ -95,4 +129,93 @@ namespace OpenGL {
         return updated | material.OnImGui();
     }
 
-}
\ No newline at end of file
+    bool AABB::Intersects(const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax) const {
+        glm::vec3 minimum = glm::vec3(position) - glm::vec3(dimensions);
+        glm::vec3 maximum = glm::vec3(position) + glm::vec3(dimensions);
+
+        // Taken from Real Time Collision Detection, Chapter 5.
+        float currentTMin = 0.0f;
+        float currentTMax = std::numeric_limits<float>::max();
+
+        for (int axis = 0; axis < 3; ++axis) {
+            if (glm::abs(direction[axis]) < std::numeric_limits<float>::epsilon()) {
+                // Ray is parallel to the slab, no intersection can happen unless the origin is within the bounds of the slab.
+                if (origin[axis] < minimum[axis] || origin[axis] > maximum[axis]) {
+                    return false;
+                }
+            }
+            else {
+                // Compute times at which ray enters and leaves the slab.
+                float inverseDirection = 1.0f / direction[axis];
+                float t1 = (minimum[axis] - origin[axis]) * inverseDirection;
+                float t2 = (maximum[axis] - origin[axis]) * inverseDirection;
+
+                // Make t1 be the intersection time with the near plane, t2 be the intersection time with the far plane.
+                if (t1 > t2) {
+                    std::swap(t1, t2);
+                }
+
+                currentTMin = glm::max(currentTMin, t1);
+                currentTMax = glm::min(currentTMax, t2);
+
+                if (currentTMin > currentTMax) {
+                    return false;
+                }
+            }
+        }
+
+        // Intersection time is currentTMin.
+        // Bounds check.
+        if (currentTMin < tMin || currentTMin > tMax) {
+            // Closer intersection has already been found.
+            return false;
+        }
+
+        tMax = currentTMin;
+        return true;
+    }
+
+
+    Instance::Instance() : objectToWorld { glm::vec4(1.0f, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f), glm::vec4(0.0f, 0.0f, 1.0f, 0.0f) },
+                           worldToObject { glm::vec4(1.0f, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f), glm::vec4(0.0f, 0.0f, 1.0f, 0.0f) },
+                           primitiveType(PrimitiveType::Sphere),
+                           primitiveIndex(0)
+                           {
+    }
+
+    void Instance::SetTransform(const glm::mat4& transform) {
+        glm::mat4 inverse = glm::inverse(transform);
+
+        // glm matrices are column major.
+        glm::mat4 transposed = glm::transpose(transform);
+        glm::mat4 inverseTransposed = glm::transpose(inverse);
+
+        for (int row = 0; row < 3; ++row) {
+            objectToWorld[row] = transposed[row];
+            worldToObject[row] = inverseTransposed[row];
+        }
+    }
+
+    bool Instance::Intersects(const std::vector<Sphere>& spheres, const std::vector<AABB>& aabbs, const glm::vec3& origin, const glm::vec3& direction, float tMin, float& tMax) const {
+        glm::vec3 objectOrigin = glm::vec3(glm::dot(worldToObject[0], glm::vec4(origin, 1.0f)),
+                                           glm::dot(worldToObject[1], glm::vec4(origin, 1.0f)),
+                                           glm::dot(worldToObject[2], glm::vec4(origin, 1.0f)));
+        glm::vec3 objectDirection = glm::vec3(glm::dot(worldToObject[0], glm::vec4(direction, 0.0f)),
+                                              glm::dot(worldToObject[1], glm::vec4(direction, 0.0f)),
+                                              glm::dot(worldToObject[2], glm::vec4(direction, 0.0f)));
+
+        // Intersection times scale with the length of the transformed direction.
+        float scale = glm::length(objectDirection);
+        float objectTMax = tMax * scale;
+
+        bool intersected = primitiveType == PrimitiveType::Sphere ? spheres[primitiveIndex].Intersects(objectOrigin, objectDirection / scale, tMin * scale, objectTMax)
+                                                                  : aabbs[primitiveIndex].Intersects(objectOrigin, objectDirection / scale, tMin * scale, objectTMax);
+        if (!intersected) {
+            return false;
+        }
+
+        tMax = objectTMax / scale;
+        return true;
+    }
+
+}
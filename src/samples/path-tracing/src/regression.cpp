@@ -0,0 +1,252 @@
+
+#include "pch.h"
+#include "regression.h"
+#include "offline_renderer.h"
+#include "hdr_image.h"
+
+namespace OpenGL {
+
+    RegressionSuite::RegressionSuite(std::string referenceDirectory) : referenceDirectory_(std::move(referenceDirectory)),
+                                                                       width_(160),
+                                                                       height_(90),
+                                                                       tolerances_ { 0.05f, 0.01f, 0.001f, 0.1f, 0.25f } {
+        outputDirectory_ = referenceDirectory_ + "output/";
+
+        // Every scene covers a different part of the path tracer: the whole room (emissive light, walls), reflective
+        // materials of varying roughness, refractive materials with absorption, and transformed instances.
+        scenes_ = {
+            { "overview",   glm::vec3(0.0f, 0.0f, 25.0f),  glm::vec3(0.0f),                 32, 8 },
+            { "reflection", glm::vec3(-8.0f, 0.0f, 0.0f),  glm::vec3(15.0f, 0.0f, 0.0f),    32, 8 },
+            { "refraction", glm::vec3(8.0f, 0.0f, 0.0f),   glm::vec3(-15.0f, 0.0f, 0.0f),   32, 8 },
+            { "instances",  glm::vec3(0.0f, 5.0f, 18.0f),  glm::vec3(0.0f, -12.0f, 0.0f),   32, 8 }
+        };
+    }
+
+    RegressionSuite::~RegressionSuite() {
+    }
+
+    RegressionResult RegressionSuite::Run(bool updateReferences) {
+        std::unique_ptr<OfflineRenderer> renderer;
+        try {
+            renderer = std::make_unique<OfflineRenderer>(width_, height_, 1);
+        }
+        catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return RegressionResult::Failed;
+        }
+
+        // Budgets are specific to the machine, they are only checked once generated on it.
+        if (!updateReferences && !ReadBudgets()) {
+            std::cout << "No time budgets in '" << referenceDirectory_ << "budgets.txt', timings are not checked (generate them with --update-references)." << std::endl;
+        }
+
+        std::filesystem::create_directories(outputDirectory_);
+        std::ofstream timings(outputDirectory_ + "timings.csv", std::ios::app);
+
+        long long timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // The first dispatches may include driver-side shader compilation.
+        {
+            std::vector<float> warmup = renderer->Render(glm::ivec2(0), glm::ivec2(width_, height_), 0, 1);
+        }
+
+        int numPassed = 0;
+        int numSkipped = 0;
+
+        for (const RegressionScene& scene : scenes_) {
+            if (!updateReferences && !HasReferences(scene)) {
+                std::cout << "[SKIP] " << scene.name << ": no reference images in '" << referenceDirectory_ << "' (generate them with --update-references)." << std::endl;
+                ++numSkipped;
+                continue;
+            }
+
+            renderer->SetCamera(scene.cameraPosition, scene.cameraTarget);
+            renderer->SetNumRayBounces(scene.numRayBounces);
+
+            // Reading back the result waits for the GPU to finish rendering.
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<float> radiance = renderer->Render(glm::ivec2(0), glm::ivec2(width_, height_), 0, scene.samplesPerPixel);
+
+            float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            float timePerSample = elapsed / static_cast<float>(scene.samplesPerPixel);
+
+            std::vector<float> output = renderer->PostProcess(1.0f);
+
+            std::string directory = updateReferences ? referenceDirectory_ : outputDirectory_;
+            if (!WriteHDRImage(directory + scene.name, HDRFormat::PFM, width_, height_, { { "", radiance.data(), 3 } }) ||
+                !WriteHDRImage(directory + scene.name + "_output", HDRFormat::PFM, width_, height_, { { "", output.data(), 3 } })) {
+                std::cerr << "Failed to write images of scene '" << scene.name << "' to '" << directory << "'." << std::endl;
+            }
+
+            if (updateReferences) {
+                budgets_[scene.name] = timePerSample;
+                std::cout << "Updated reference of scene '" << scene.name << "' (" << timePerSample << " ms per sample)." << std::endl;
+                ++numPassed;
+                continue;
+            }
+
+            // All checks run (and report) even after one of them failed.
+            bool passed = Compare(scene, "", radiance, tolerances_.radianceRMSE, true, false);
+            passed = Compare(scene, "_output", output, tolerances_.outputRMSE, false, true) && passed;
+
+            // Scenes without a budget are only checked for their images.
+            auto budget = budgets_.find(scene.name);
+            if (budget != budgets_.end() && timePerSample > budget->second * (1.0f + tolerances_.frameTime)) {
+                std::cerr << "Scene '" << scene.name << "' took " << timePerSample << " ms per sample, exceeding its budget of " << budget->second << " ms by more than " << tolerances_.frameTime * 100.0f << "%." << std::endl;
+                passed = false;
+            }
+
+            float budgetTime = budget != budgets_.end() ? budget->second : 0.0f;
+            timings << timestamp << "," << scene.name << "," << timePerSample << "," << budgetTime << "," << (passed ? "pass" : "fail") << std::endl;
+
+            std::cout << (passed ? "[PASS] " : "[FAIL] ") << scene.name << ": " << timePerSample << " ms per sample (";
+            if (budget != budgets_.end()) {
+                std::cout << "budget " << budgetTime << " ms";
+            }
+            else {
+                std::cout << "no budget";
+            }
+            std::cout << ")." << std::endl;
+
+            if (passed) {
+                ++numPassed;
+            }
+        }
+
+        if (updateReferences) {
+            if (!WriteBudgets()) {
+                std::cerr << "Failed to write '" << referenceDirectory_ << "budgets.txt'." << std::endl;
+                return RegressionResult::Failed;
+            }
+
+            return RegressionResult::Passed;
+        }
+
+        int numScenes = static_cast<int>(scenes_.size());
+        int numFailed = numScenes - numPassed - numSkipped;
+
+        if (numFailed > 0) {
+            std::cerr << "REGRESSION: " << numFailed << " of " << numScenes << " scenes failed, see '" << outputDirectory_ << "'." << std::endl;
+            return RegressionResult::Failed;
+        }
+
+        if (numSkipped == numScenes) {
+            std::cout << "Skipped all " << numScenes << " regression scenes, no references to compare against." << std::endl;
+            return RegressionResult::Skipped;
+        }
+
+        std::cout << "All " << numPassed << " checked regression scenes passed (" << numSkipped << " skipped)." << std::endl;
+        return RegressionResult::Passed;
+    }
+
+    RegressionTolerances& RegressionSuite::GetTolerances() {
+        return tolerances_;
+    }
+
+    bool RegressionSuite::HasReferences(const RegressionScene& scene) const {
+        return std::filesystem::exists(referenceDirectory_ + scene.name + ".pfm") && std::filesystem::exists(referenceDirectory_ + scene.name + "_output.pfm");
+    }
+
+    bool RegressionSuite::Compare(const RegressionScene& scene, const std::string& suffix, const std::vector<float>& image, float rmseTolerance, bool relative, bool checkOutliers) const {
+        std::string name = scene.name + suffix;
+
+        int width;
+        int height;
+        std::vector<float> reference;
+
+        if (!ReadPFMImage(referenceDirectory_ + name + ".pfm", width, height, reference)) {
+            std::cerr << "Failed to read reference '" << referenceDirectory_ << name << ".pfm'." << std::endl;
+            return false;
+        }
+
+        if (width != width_ || height != height_) {
+            std::cerr << "Reference '" << name << "' is " << width << "x" << height << ", expected " << width_ << "x" << height_ << "." << std::endl;
+            return false;
+        }
+
+        std::vector<float> difference(image.size());
+        double squaredError = 0.0;
+        double sum = 0.0;
+        int numOutliers = 0;
+
+        for (std::size_t pixel = 0; pixel < image.size(); pixel += 3) {
+            float maximumError = 0.0f;
+
+            for (std::size_t component = pixel; component < pixel + 3; ++component) {
+                float error = image[component] - reference[component];
+
+                difference[component] = std::abs(error);
+                maximumError = std::max(maximumError, std::abs(error));
+
+                squaredError += static_cast<double>(error) * error;
+                sum += reference[component];
+            }
+
+            if (maximumError > tolerances_.outlierThreshold) {
+                ++numOutliers;
+            }
+        }
+
+        float rmse = static_cast<float>(std::sqrt(squaredError / static_cast<double>(image.size())));
+        if (relative) {
+            float mean = static_cast<float>(sum / static_cast<double>(image.size()));
+            rmse /= std::max(mean, 1e-6f);
+        }
+
+        float outliers = static_cast<float>(numOutliers) / static_cast<float>(width_ * height_);
+
+        bool passed = true;
+
+        if (rmse > rmseTolerance) {
+            std::cerr << "Image '" << name << "' differs from its reference: " << (relative ? "relative " : "") << "RMSE " << rmse << " exceeds " << rmseTolerance << "." << std::endl;
+            passed = false;
+        }
+
+        if (checkOutliers && outliers > tolerances_.outliers) {
+            std::cerr << "Image '" << name << "' differs from its reference: " << outliers * 100.0f << "% of pixels differ by more than " << tolerances_.outlierThreshold << " (at most " << tolerances_.outliers * 100.0f << "% allowed)." << std::endl;
+            passed = false;
+        }
+
+        if (!passed && !WriteHDRImage(outputDirectory_ + name + "_difference", HDRFormat::PFM, width_, height_, { { "", difference.data(), 3 } })) {
+            std::cerr << "Failed to write difference image of '" << name << "'." << std::endl;
+        }
+
+        return passed;
+    }
+
+    bool RegressionSuite::ReadBudgets() {
+        std::ifstream stream(referenceDirectory_ + "budgets.txt");
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        // One '<scene> <milliseconds per sample>' pair per line.
+        std::string name;
+        float budget;
+
+        while (stream >> name >> budget) {
+            budgets_[name] = budget;
+        }
+
+        return true;
+    }
+
+    bool RegressionSuite::WriteBudgets() const {
+        std::ofstream stream(referenceDirectory_ + "budgets.txt");
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        for (const RegressionScene& scene : scenes_) {
+            auto budget = budgets_.find(scene.name);
+            if (budget != budgets_.end()) {
+                stream << scene.name << " " << budget->second << std::endl;
+            }
+        }
+
+        return stream.good();
+    }
+
+}
@@ -0,0 +1,332 @@
+
+#include "pch.h"
+#include "render_coordinator.h"
+#include "offline_renderer.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        // Coordinators and workers of different builds can not be mixed.
+        const std::uint32_t protocolVersion = 1;
+
+        // Polling wakes up periodically to notice local workers that exited without ever connecting.
+        const int pollTimeout = 500; // Milliseconds.
+
+        enum class MessageType : std::uint32_t {
+            Hello,
+            Settings,
+            Request,
+            Job,
+            Result,
+            Done
+        };
+
+        struct MessageHeader {
+            MessageType type;
+            std::uint32_t size; // Bytes of payload following the header.
+        };
+
+        struct JobDescription {
+            std::int32_t id;
+            std::int32_t x;
+            std::int32_t y;
+            std::int32_t width;
+            std::int32_t height;
+            std::int32_t firstSample;
+            std::int32_t numSamples;
+        };
+
+        bool WriteMessage(const Socket& socket, MessageType type, const void* payload = nullptr, std::size_t size = 0) {
+            MessageHeader header { type, static_cast<std::uint32_t>(size) };
+            return socket.Send(&header, sizeof(header)) && (size == 0 || socket.Send(payload, size));
+        }
+
+    }
+
+    RenderCoordinator::RenderCoordinator(const RenderSettings& settings, int tileSize, int samplesPerJob) : settings_(settings),
+                                                                                                            numCompletedJobs_(0),
+                                                                                                            image_(static_cast<std::size_t>(settings.width) * static_cast<std::size_t>(settings.height) * 3, 0.0f) {
+        tileSize = std::max(tileSize, 1);
+        samplesPerJob = std::max(samplesPerJob, 1);
+
+        for (int y = 0; y < settings_.height; y += tileSize) {
+            for (int x = 0; x < settings_.width; x += tileSize) {
+                tiles_.emplace_back(x, y, std::min(tileSize, settings_.width - x), std::min(tileSize, settings_.height - y));
+            }
+        }
+
+        numTileSamples_.resize(tiles_.size(), 0);
+
+        // Every tile receives its first range of samples before any tile receives its second, so the whole image
+        // converges evenly.
+        for (int firstSample = 0; firstSample < settings_.samplesPerPixel; firstSample += samplesPerJob) {
+            for (int tile = 0; tile < static_cast<int>(tiles_.size()); ++tile) {
+                pendingJobs_.push_back(static_cast<int>(jobs_.size()));
+                jobs_.push_back({ tile, firstSample, std::min(samplesPerJob, settings_.samplesPerPixel - firstSample) });
+            }
+        }
+    }
+
+    RenderCoordinator::~RenderCoordinator() {
+    }
+
+    bool RenderCoordinator::Listen(int port) {
+        listener_ = Socket::Listen(port);
+        return listener_.IsValid();
+    }
+
+    int RenderCoordinator::GetPort() const {
+        return listener_.GetPort();
+    }
+
+    bool RenderCoordinator::Run(int numLocalWorkers, const std::atomic<int>& numExitedLocalWorkers) {
+        int progress = 0; // Percent, reported in steps of 10.
+
+        while (numCompletedJobs_ < jobs_.size()) {
+            // Local workers that failed to start (or crashed) leave nothing to wait for, workers started by hand are
+            // only waited for while a local worker is still running.
+            if (workers_.empty() && numLocalWorkers > 0 && numExitedLocalWorkers.load() >= numLocalWorkers) {
+                std::cerr << "All local workers exited with " << (jobs_.size() - numCompletedJobs_) << " jobs left, no worker is connected." << std::endl;
+                return false;
+            }
+
+            std::vector<const Socket*> sockets { &listener_ };
+            for (const std::unique_ptr<Worker>& worker : workers_) {
+                sockets.push_back(&worker->socket);
+            }
+
+            // Blocks until a worker connects, sends a message, or disconnects (or the timeout expires).
+            std::vector<bool> ready = Socket::Poll(sockets, pollTimeout);
+
+            // Ready workers are handled from the back, so disconnecting one does not shift the ones not handled yet.
+            for (std::size_t i = workers_.size(); i > 0; --i) {
+                if (ready[i] && !ReceiveMessage(*workers_[i - 1])) {
+                    Disconnect(i - 1);
+                }
+            }
+
+            if (ready[0]) {
+                Socket socket = listener_.Accept();
+                if (socket.IsValid()) {
+                    workers_.emplace_back(std::make_unique<Worker>(Worker { std::move(socket), -1, false }));
+                    std::cout << "Worker connected (" << workers_.size() << " connected)." << std::endl;
+                }
+            }
+
+            // Hand out pending jobs to waiting workers.
+            for (std::size_t i = workers_.size(); i > 0; --i) {
+                Worker& worker = *workers_[i - 1];
+                if (!worker.waiting || pendingJobs_.empty()) {
+                    continue;
+                }
+
+                int job = pendingJobs_.front();
+                pendingJobs_.pop_front();
+
+                if (!SendJob(worker, job)) {
+                    Disconnect(i - 1);
+                }
+            }
+
+            int completed = static_cast<int>(numCompletedJobs_ * 100 / jobs_.size());
+            if (completed / 10 > progress / 10) {
+                progress = completed;
+                std::cout << "Rendered " << progress << "% (" << numCompletedJobs_ << " / " << jobs_.size() << " jobs)." << std::endl;
+            }
+        }
+
+        // Workers that are still connected exit once they receive Done.
+        for (const std::unique_ptr<Worker>& worker : workers_) {
+            WriteMessage(worker->socket, MessageType::Done);
+        }
+
+        workers_.clear();
+        return true;
+    }
+
+    const std::vector<float>& RenderCoordinator::GetImage() const {
+        return image_;
+    }
+
+    bool RenderCoordinator::ReceiveMessage(Worker& worker) {
+        MessageHeader header { };
+        if (!worker.socket.Receive(&header, sizeof(header))) {
+            return false;
+        }
+
+        switch (header.type) {
+            case MessageType::Hello: {
+                std::uint32_t version = 0;
+                if (header.size != sizeof(version) || !worker.socket.Receive(&version, sizeof(version))) {
+                    return false;
+                }
+
+                if (version != protocolVersion) {
+                    std::cerr << "Rejected worker with protocol version " << version << " (expected " << protocolVersion << ")." << std::endl;
+                    return false;
+                }
+
+                std::int32_t settings[4] = { settings_.width, settings_.height, settings_.samplesPerPixel, settings_.numRayBounces };
+                return WriteMessage(worker.socket, MessageType::Settings, settings, sizeof(settings));
+            }
+
+            case MessageType::Request:
+                worker.waiting = true;
+                return true;
+
+            case MessageType::Result: {
+                JobDescription description { };
+                if (header.size < sizeof(description) || !worker.socket.Receive(&description, sizeof(description))) {
+                    return false;
+                }
+
+                // Results can only ever be for the job the worker was handed.
+                if (worker.job < 0 || description.id != worker.job) {
+                    std::cerr << "Received result for job " << description.id << ", expected job " << worker.job << "." << std::endl;
+                    return false;
+                }
+
+                const glm::ivec4& tile = tiles_[jobs_[worker.job].tile];
+                std::vector<float> radiance(static_cast<std::size_t>(tile.z) * static_cast<std::size_t>(tile.w) * 3);
+
+                if (header.size != sizeof(description) + radiance.size() * sizeof(float) || !worker.socket.Receive(radiance.data(), radiance.size() * sizeof(float))) {
+                    return false;
+                }
+
+                Merge(jobs_[worker.job], radiance);
+                ++numCompletedJobs_;
+
+                // Workers wait for their next job right after sending a result.
+                worker.job = -1;
+                worker.waiting = true;
+                return true;
+            }
+
+            default:
+                std::cerr << "Received unexpected message from worker." << std::endl;
+                return false;
+        }
+    }
+
+    bool RenderCoordinator::SendJob(Worker& worker, int job) {
+        const glm::ivec4& tile = tiles_[jobs_[job].tile];
+        JobDescription description { job, tile.x, tile.y, tile.z, tile.w, jobs_[job].firstSample, jobs_[job].numSamples };
+
+        // The job is requeued if sending fails, as the worker is disconnected.
+        worker.job = job;
+        worker.waiting = false;
+
+        return WriteMessage(worker.socket, MessageType::Job, &description, sizeof(description));
+    }
+
+    void RenderCoordinator::Disconnect(std::size_t index) {
+        Worker& worker = *workers_[index];
+
+        // Another worker picks up the job next.
+        if (worker.job >= 0) {
+            pendingJobs_.push_front(worker.job);
+        }
+
+        workers_.erase(workers_.begin() + static_cast<std::ptrdiff_t>(index));
+        std::cout << "Worker disconnected (" << workers_.size() << " connected)." << std::endl;
+    }
+
+    void RenderCoordinator::Merge(const Job& job, const std::vector<float>& radiance) {
+        const glm::ivec4& tile = tiles_[job.tile];
+        int& numSamples = numTileSamples_[job.tile];
+
+        // Both the merged image and the result are averages, weighted by the number of samples they contain.
+        float weight = static_cast<float>(job.numSamples) / static_cast<float>(numSamples + job.numSamples);
+
+        for (int y = 0; y < tile.w; ++y) {
+            for (int x = 0; x < tile.z; ++x) {
+                std::size_t source = (static_cast<std::size_t>(y) * tile.z + x) * 3;
+                std::size_t destination = (static_cast<std::size_t>(tile.y + y) * settings_.width + (tile.x + x)) * 3;
+
+                for (int component = 0; component < 3; ++component) {
+                    float& value = image_[destination + component];
+                    value += (radiance[source + component] - value) * weight;
+                }
+            }
+        }
+
+        numSamples += job.numSamples;
+    }
+
+    RenderWorker::RenderWorker(int port, int maxJobs) : port_(port),
+                                                        maxJobs_(maxJobs) {
+    }
+
+    RenderWorker::~RenderWorker() {
+    }
+
+    bool RenderWorker::Run() {
+        Socket connection = Socket::Connect(port_);
+        if (!connection.IsValid()) {
+            std::cerr << "Failed to connect to coordinator on port " << port_ << "." << std::endl;
+            return false;
+        }
+
+        MessageHeader header { };
+        std::int32_t settings[4];
+
+        if (!WriteMessage(connection, MessageType::Hello, &protocolVersion, sizeof(protocolVersion)) ||
+            !connection.Receive(&header, sizeof(header)) || header.type != MessageType::Settings || header.size != sizeof(settings) ||
+            !connection.Receive(settings, sizeof(settings))) {
+            std::cerr << "Failed to receive render settings from coordinator." << std::endl;
+            return false;
+        }
+
+        std::unique_ptr<OfflineRenderer> renderer;
+        try {
+            renderer = std::make_unique<OfflineRenderer>(settings[0], settings[1], settings[3]);
+        }
+        catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return false;
+        }
+
+        if (!WriteMessage(connection, MessageType::Request)) {
+            return false;
+        }
+
+        int numJobs = 0;
+
+        while (maxJobs_ < 0 || numJobs < maxJobs_) {
+            if (!connection.Receive(&header, sizeof(header))) {
+                std::cerr << "Lost connection to coordinator." << std::endl;
+                return false;
+            }
+
+            if (header.type == MessageType::Done) {
+                return true;
+            }
+
+            JobDescription description { };
+            if (header.type != MessageType::Job || header.size != sizeof(description) || !connection.Receive(&description, sizeof(description))) {
+                std::cerr << "Received unexpected message from coordinator." << std::endl;
+                return false;
+            }
+
+            std::vector<float> radiance = renderer->Render(glm::ivec2(description.x, description.y), glm::ivec2(description.width, description.height), description.firstSample, description.numSamples);
+
+            // The coordinator hands out the next job as soon as the result is received.
+            MessageHeader result { MessageType::Result, static_cast<std::uint32_t>(sizeof(description) + radiance.size() * sizeof(float)) };
+
+            if (!connection.Send(&result, sizeof(result)) ||
+                !connection.Send(&description, sizeof(description)) ||
+                !connection.Send(radiance.data(), radiance.size() * sizeof(float))) {
+                std::cerr << "Lost connection to coordinator." << std::endl;
+                return false;
+            }
+
+            ++numJobs;
+        }
+
+        // Leaving mid-render, the job handed out with the last result (if any) is given to another worker.
+        std::cout << "Leaving after " << numJobs << " jobs." << std::endl;
+        return true;
+    }
+
+}
@@ -0,0 +1,168 @@
+
+#include "pch.h"
+#include "scaling_benchmark.h"
+#include "scene.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        struct IntegratorMode {
+            Integrator integrator;
+            std::string name;
+        };
+
+        const std::vector<IntegratorMode> integrators = {
+            { Integrator::Megakernel,      "megakernel" },
+            { Integrator::Wavefront,       "wavefront" },
+            { Integrator::WavefrontSorted, "wavefront_sorted" }
+        };
+
+        float ToMegabytes(std::size_t bytes) {
+            return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+        }
+
+    }
+
+    ScalingBenchmark::ScalingBenchmark(ScalingSettings settings) : settings_(std::move(settings)) {
+    }
+
+    ScalingBenchmark::~ScalingBenchmark() {
+    }
+
+    bool ScalingBenchmark::Run() {
+        std::unique_ptr<OfflineRenderer> renderer;
+        try {
+            renderer = std::make_unique<OfflineRenderer>(settings_.width, settings_.height, settings_.numRayBounces);
+        }
+        catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return false;
+        }
+
+        glm::ivec2 size(settings_.width, settings_.height);
+        float numPixels = static_cast<float>(settings_.width) * static_cast<float>(settings_.height);
+
+        // Time per frame of every integrator on the previous scene, negative once the integrator exceeded the time limit.
+        std::vector<float> previousTime(integrators.size(), 0.0f);
+        int previousSize = 0;
+
+        for (int numPrimitives : settings_.sceneSizes) {
+            renderer->SetScene(std::make_unique<Scene>(numPrimitives, 1337u));
+            Scene& scene = renderer->GetScene();
+
+            glm::vec3 center = (scene.GetMinimum() + scene.GetMaximum()) / 2.0f;
+            float radius = glm::length(scene.GetMaximum() - scene.GetMinimum()) / 2.0f;
+
+            for (std::size_t i = 0; i < integrators.size(); ++i) {
+                ScalingResult result { };
+                result.numPrimitives = numPrimitives;
+                result.integrator = integrators[i].name;
+                result.sceneMemory = scene.GetMemoryUsage();
+
+                float predictedTime = previousSize > 0 ? previousTime[i] * static_cast<float>(numPrimitives) / static_cast<float>(previousSize) : 0.0f;
+                if (previousTime[i] < 0.0f || predictedTime > settings_.timeLimit) {
+                    std::cout << "Skipping " << integrators[i].name << " on " << numPrimitives << " primitives (expected to exceed " << settings_.timeLimit << " ms per frame)." << std::endl;
+
+                    result.skipped = true;
+                    results_.emplace_back(result);
+                    previousTime[i] = -1.0f;
+                    continue;
+                }
+
+                renderer->SetIntegrator(integrators[i].integrator);
+
+                // The first dispatches may include driver-side shader compilation.
+                {
+                    renderer->SetCamera(center + glm::vec3(0.0f, 0.0f, 1.5f * radius), center);
+                    std::vector<float> warmup = renderer->Render(glm::ivec2(0), size, 0, 1);
+                }
+
+                float totalTime = 0.0f;
+                float totalWallTime = 0.0f;
+
+                // Orbit around the scene, slightly from above.
+                for (int frame = 0; frame < settings_.framesPerConfiguration; ++frame) {
+                    float angle = glm::radians(360.0f * static_cast<float>(frame) / static_cast<float>(settings_.framesPerConfiguration));
+                    renderer->SetCamera(center + glm::vec3(glm::sin(angle), 0.3f, glm::cos(angle)) * 1.5f * radius, center);
+
+                    // Reading back the result waits for the GPU to finish rendering.
+                    glFinish();
+                    auto start = std::chrono::steady_clock::now();
+
+                    std::vector<float> radiance = renderer->Render(glm::ivec2(0), size, frame, 1);
+
+                    totalWallTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    totalTime += renderer->GetRenderMilliseconds();
+                }
+
+                result.skipped = false;
+                result.millisecondsPerFrame = totalTime / static_cast<float>(glm::max(settings_.framesPerConfiguration, 1));
+                result.wallMillisecondsPerFrame = totalWallTime / static_cast<float>(glm::max(settings_.framesPerConfiguration, 1));
+                result.primaryRaysPerSecond = result.millisecondsPerFrame > 0.0f ? numPixels / (result.millisecondsPerFrame * 1000.0f) : 0.0f;
+                result.integratorMemory = renderer->GetMemoryUsage();
+
+                std::cout << integrators[i].name << ", " << numPrimitives << " primitives: " << result.millisecondsPerFrame << " ms per frame (GPU), "
+                          << result.wallMillisecondsPerFrame << " ms including the readback." << std::endl;
+
+                results_.emplace_back(result);
+                previousTime[i] = result.millisecondsPerFrame > settings_.timeLimit ? -1.0f : result.millisecondsPerFrame;
+            }
+
+            previousSize = numPrimitives;
+        }
+
+        return true;
+    }
+
+    void ScalingBenchmark::WriteTable(std::ostream& stream) const {
+        char line[256];
+
+        std::snprintf(line, sizeof(line), "%12s  %-18s  %12s  %12s  %12s  %12s  %12s", "Primitives", "Integrator", "GPU ms", "Wall ms", "Mrays / s", "Scene (MB)", "Buffers (MB)");
+        stream << line << std::endl;
+
+        for (const ScalingResult& result : results_) {
+            if (result.skipped) {
+                std::snprintf(line, sizeof(line), "%12d  %-18s  %12s  %12s  %12s  %12.2f  %12s", result.numPrimitives, result.integrator.c_str(), "-", "-", "-", ToMegabytes(result.sceneMemory), "-");
+            }
+            else {
+                std::snprintf(line, sizeof(line), "%12d  %-18s  %12.2f  %12.2f  %12.3f  %12.2f  %12.2f", result.numPrimitives, result.integrator.c_str(), result.millisecondsPerFrame, result.wallMillisecondsPerFrame,
+                              result.primaryRaysPerSecond, ToMegabytes(result.sceneMemory), ToMegabytes(result.integratorMemory));
+            }
+
+            stream << line << std::endl;
+        }
+    }
+
+    void ScalingBenchmark::WriteJSON(std::ostream& stream) const {
+        stream << "{" << std::endl;
+        stream << "    \"settings\": {" << std::endl;
+        stream << "        \"width\": " << settings_.width << "," << std::endl;
+        stream << "        \"height\": " << settings_.height << "," << std::endl;
+        stream << "        \"bounces\": " << settings_.numRayBounces << "," << std::endl;
+        stream << "        \"frames\": " << settings_.framesPerConfiguration << "," << std::endl;
+        stream << "        \"time_limit_ms\": " << settings_.timeLimit << "," << std::endl;
+        stream << "        \"renderer\": \"" << (const char*)(glGetString(GL_RENDERER)) << "\"" << std::endl;
+        stream << "    }," << std::endl;
+        stream << "    \"results\": [";
+
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const ScalingResult& result = results_[i];
+
+            stream << (i ? "," : "") << std::endl;
+            stream << "        { \"primitives\": " << result.numPrimitives << ", \"integrator\": \"" << result.integrator << "\", \"skipped\": " << (result.skipped ? "true" : "false")
+                   << ", \"scene_memory_bytes\": " << result.sceneMemory;
+
+            if (!result.skipped) {
+                stream << ", \"ms_per_frame\": " << result.millisecondsPerFrame << ", \"wall_ms_per_frame\": " << result.wallMillisecondsPerFrame << ", \"primary_mrays_per_second\": " << result.primaryRaysPerSecond
+                       << ", \"integrator_memory_bytes\": " << result.integratorMemory;
+            }
+
+            stream << " }";
+        }
+
+        stream << std::endl << "    ]" << std::endl;
+        stream << "}" << std::endl;
+    }
+
+}
@@ -0,0 +1,454 @@
+
+#include "pch.h"
+#include "scene.h"
+
+#include <random>
+
+namespace OpenGL {
+
+    namespace {
+
+        // Matches the array sizes in path_tracing.comp.
+        const int maxSpheres = 256;
+        const int maxAABBs = 256;
+
+    }
+
+    Scene::Scene() : spheres_(maxSpheres),
+                     numActiveSpheres_(0),
+                     aabbs_(maxAABBs),
+                     numActiveAABBs_(0),
+                     minimum_(std::numeric_limits<float>::max()),
+                     maximum_(std::numeric_limits<float>::lowest()),
+                     memoryUsage_(0),
+                     objectBuffer_(0),
+                     instanceBuffer_(0) {
+        int index = 0;
+
+        // 6x6 grid of spheres to showcase varying levels of both reflective materials and reflection roughness properties.
+        {
+            int side = 6;
+            float radius = 2.0f;
+            float gap = 1.0f;
+
+            float length = (radius * 2.0f) * static_cast<float>(side) + gap * static_cast<float>(side);
+            float offset = length / 2.0f;
+            float delta = length / static_cast<float>(side - 1);
+
+            for (int y = 0; y < side; ++y) {
+                for (int x = 0; x < side; ++x) {
+                    Sphere& sphere = spheres_[index++];
+                    sphere.radius = radius;
+                    sphere.position = glm::vec3(15.0f, static_cast<float>(y) * delta - offset, static_cast<float>(x) * delta - offset);
+
+                    // Configure material properties.
+                    Material& material = sphere.material;
+                    material.albedo = glm::vec3(1.0f);
+                    material.reflectionProbability = static_cast<float>(side - 1 - x) / (static_cast<float>(side - 1));
+                    material.reflectionRoughness = static_cast<float>(y) / (static_cast<float>(side - 1));
+
+                    ++numActiveSpheres_;
+                }
+            }
+        }
+
+        // 1x6 grid of spheres to showcase refractive materials with varying levels of absorbance (Beer's Law).
+        {
+            int side = 6;
+            float radius = 2.0f;
+            float gap = 1.0f;
+
+            float length = (radius * 2.0f) * static_cast<float>(side) + gap * static_cast<float>(side);
+            float offset = length / 2.0f;
+            float delta = length / static_cast<float>(side - 1);
+
+            for (int i = 0; i < side; ++i) {
+                Sphere& sphere = spheres_[index++];
+                sphere.radius = radius;
+                sphere.position = glm::vec3(-15.0f, length / 4.0f, static_cast<float>(i) * delta - offset);
+
+                // Configure material properties.
+                Material& material = sphere.material;
+                material.albedo = glm::vec3(0.90f, 0.25f, 0.25f);
+                material.ior = 1.05f;
+                material.refractionProbability = 0.98f;
+                material.absorbance = glm::vec3(1.0f, 2.0f, 3.0f) * (static_cast<float>(i) / static_cast<float>(side));
+                material.reflectionProbability = 0.02f;
+
+                ++numActiveSpheres_;
+            }
+        }
+
+        // 1x6 grid of spheres to showcase refractive materials with varying levels of refraction roughness.
+        {
+            int side = 6;
+            float radius = 2.0f;
+            float gap = 1.0f;
+
+            float length = (radius * 2.0f) * static_cast<float>(side) + gap * static_cast<float>(side);
+            float offset = length / 2.0f;
+            float delta = length / static_cast<float>(side - 1);
+
+            for (int i = 0; i < side; ++i) {
+                Sphere& sphere = spheres_[index++];
+                sphere.radius = radius;
+                sphere.position = glm::vec3(-15.0f, -length / 4.0f, static_cast<float>(i) * delta - offset);
+
+                // Configure material properties.
+                Material& material = sphere.material;
+                material.ior = 1.1f;
+                material.refractionProbability = 0.98f;
+                material.refractionRoughness = (static_cast<float>(side - 1 - i) / static_cast<float>(side));
+                material.reflectionProbability = 0.02f;
+                material.reflectionRoughness = (static_cast<float>(i) / static_cast<float>(side));
+
+                ++numActiveSpheres_;
+            }
+        }
+
+        index = 0;
+
+        // Box consisting of 6 thin AABB slabs around the demo scene.
+        {
+            float epsilon = 0.01f;
+            float boxHeight = 40.0f;
+            float boxWidth = 40.0f;
+            float boxDepth = 56.0f;
+
+            // Right wall (green).
+            {
+                AABB& wall = aabbs_[index++];
+                wall.position = glm::vec4(boxWidth / 2.0f, 0.0f, 0.0f, 1.0f);
+                wall.dimensions = glm::vec4(epsilon, boxHeight / 2.0f + epsilon, boxDepth / 2.0f + epsilon, 0.0f);
+
+                Material& material = wall.material;
+                material.albedo = glm::vec3(0.37f, 0.67f, 0.37f);
+                material.reflectionProbability = 1.0f;
+                material.reflectionRoughness = 0.6f;
+
+                ++numActiveAABBs_;
+            }
+
+            // Left wall (transparent).
+            {
+                AABB& wall = aabbs_[index++];
+                wall.position = glm::vec4(-boxWidth / 2.0f, 0.0f, 0.0f, 1.0f);
+                wall.dimensions = glm::vec4(epsilon, boxHeight / 2.0f + epsilon, boxDepth / 2.0f + epsilon, 0.0f);
+
+                Material& material = wall.material;
+                material.albedo = glm::vec3(1.0f);
+                material.ior = 1.52f; // Glass.
+                material.refractionProbability = 1.0f;
+                material.absorbance = glm::vec3(0.1f);
+
+                ++numActiveAABBs_;
+            }
+
+            // Back wall (blue).
+            {
+                AABB& wall = aabbs_[index++];
+                wall.position = glm::vec4(0.0f, 0.0f, boxDepth / 2.0f, 1.0f);
+                wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, boxHeight / 2.0f + epsilon, epsilon, 0.0f);
+
+                Material& material = wall.material;
+                material.albedo = glm::vec3(0.07f, 0.25f, 0.45f);
+                material.reflectionProbability = 1.0f;
+                material.reflectionRoughness = 0.6f;
+
+                ++numActiveAABBs_;
+            }
+
+            // Front wall (reflective).
+            {
+                AABB& wall = aabbs_[index++];
+                wall.position = glm::vec4(0.0f, 0.0f, -boxDepth / 2.0f, 1.0f);
+                wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, boxHeight / 2.0f + epsilon, epsilon, 0.0f);
+
+                Material& material = wall.material;
+                material.albedo = glm::vec3(0.95f, 0.75f, 0.30f);
+                material.reflectionProbability = 1.0f;
+                material.reflectionRoughness = 0.25f;
+
+                ++numActiveAABBs_;
+            }
+
+            // Floor (red).
+            {
+                AABB& wall = aabbs_[index++];
+
+                wall.position = glm::vec4(0.0f, -boxHeight / 2.0f, 0.0f, 1.0f);
+                wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, epsilon, boxDepth / 2.0f + epsilon, 0.0f);
+
+                Material& material = wall.material;
+                material.albedo = glm::vec3(0.2f, 0.04f, 0.04f);
+                material.reflectionProbability = 1.0f;
+                material.reflectionRoughness = 0.6f;
+
+                ++numActiveAABBs_;
+            }
+
+            // Ceiling (transparent).
+            {
+                AABB& wall = aabbs_[index++];
+                wall.position = glm::vec4(0.0f, boxHeight / 2.0f, 0.0f, 1.0f);
+                wall.dimensions = glm::vec4(boxWidth / 2.0f + epsilon, epsilon, boxDepth / 2.0f + epsilon, 0.0f);
+
+                Material& material = wall.material;
+                material.ior = 1.52f; // Glass.
+                material.refractionProbability = 1.0f;
+                material.absorbance = glm::vec3(0.1f);
+
+                ++numActiveAABBs_;
+            }
+
+            // Light.
+            {
+                AABB& light = aabbs_[index++];
+                light.position = glm::vec4(0.0f, boxHeight / 2.0f - 2.0f, 0.0f, 1.0f);
+                light.dimensions = glm::vec4(boxWidth / 6.0f, epsilon, boxDepth / 6.0f, 0.0f);
+
+                Material& material = light.material;
+                material.emissive = glm::vec3(1.0f);
+                material.emissiveStrength = 15.0f;
+                material.reflectionProbability = 1.0f;
+
+                ++numActiveAABBs_;
+            }
+        }
+
+        // Instanced primitives.
+        // Primitives referenced by instances are defined in object space, and are stored after the active (world space)
+        // primitives so they are only ever intersected through an instance.
+        // Helix of rotated cubes, all sharing a single AABB.
+        {
+            AABB& cube = aabbs_[index];
+            cube.position = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            cube.dimensions = glm::vec4(0.5f, 0.5f, 0.5f, 0.0f);
+
+            Material& material = cube.material;
+            material.albedo = glm::vec3(0.95f, 0.75f, 0.30f);
+            material.reflectionProbability = 0.8f;
+            material.reflectionRoughness = 0.3f;
+
+            int numCubes = 96;
+            float radius = 6.0f;
+            float turns = 3.0f;
+            float height = 16.0f;
+
+            for (int i = 0; i < numCubes; ++i) {
+                float t = static_cast<float>(i) / static_cast<float>(numCubes);
+                float angle = t * turns * 360.0f;
+
+                Transform& transform = instanceTransforms_.emplace_back();
+                transform.SetPosition(radius * glm::cos(glm::radians(angle)), -19.0f + t * height, radius * glm::sin(glm::radians(angle)));
+                transform.SetRotation(angle, 45.0f, angle * 0.5f);
+
+                Instance& instance = instances_.emplace_back();
+                instance.primitiveType = PrimitiveType::AABB;
+                instance.primitiveIndex = index;
+                instance.SetTransform(transform.GetTransform());
+            }
+
+            ++index;
+        }
+
+        // Bounds of the scene, used to quantize ray origins when sorting rays.
+        for (int i = 0; i < numActiveSpheres_; ++i) {
+            minimum_ = glm::min(minimum_, spheres_[i].position - spheres_[i].radius);
+            maximum_ = glm::max(maximum_, spheres_[i].position + spheres_[i].radius);
+        }
+
+        for (int i = 0; i < numActiveAABBs_; ++i) {
+            minimum_ = glm::min(minimum_, glm::vec3(aabbs_[i].position - aabbs_[i].dimensions));
+            maximum_ = glm::max(maximum_, glm::vec3(aabbs_[i].position + aabbs_[i].dimensions));
+        }
+
+        Upload();
+    }
+
+    Scene::Scene(int numPrimitives, unsigned seed) : spheres_(maxSpheres),
+                                                     numActiveSpheres_(0),
+                                                     aabbs_(maxAABBs),
+                                                     numActiveAABBs_(0),
+                                                     minimum_(std::numeric_limits<float>::max()),
+                                                     maximum_(std::numeric_limits<float>::lowest()),
+                                                     memoryUsage_(0),
+                                                     objectBuffer_(0),
+                                                     instanceBuffer_(0) {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+        auto random = [&generator, &distribution]() {
+            return distribution(generator);
+        };
+
+        // Mostly diffuse and reflective materials, with some refractive and (rarely) emissive ones.
+        auto randomizeMaterial = [&random](Material& material) {
+            material.albedo = glm::vec3(random(), random(), random());
+
+            float type = random();
+            if (type < 0.4f) {
+                material.reflectionProbability = 1.0f;
+                material.reflectionRoughness = random();
+            }
+            else if (type < 0.6f) {
+                material.ior = 1.1f + 0.5f * random();
+                material.refractionProbability = 0.95f;
+                material.refractionRoughness = 0.2f * random();
+                material.absorbance = glm::vec3(random(), random(), random());
+                material.reflectionProbability = 0.05f;
+            }
+
+            if (random() < 0.02f) {
+                material.emissive = material.albedo;
+                material.emissiveStrength = 5.0f;
+            }
+        };
+
+        // Unit sized primitives in object space, all past the active range.
+        for (Sphere& sphere : spheres_) {
+            sphere.radius = 1.0f;
+            randomizeMaterial(sphere.material);
+        }
+
+        for (AABB& aabb : aabbs_) {
+            aabb.position = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            aabb.dimensions = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+            randomizeMaterial(aabb.material);
+        }
+
+        // Primitives are spread over a cube whose volume grows linearly with their number, so the density of the scene
+        // (and the number of primitives a ray passes before hitting one) stays the same.
+        float extent = 2.0f * std::cbrt(static_cast<float>(numPrimitives));
+
+        instances_.reserve(numPrimitives);
+        instanceTransforms_.reserve(numPrimitives);
+
+        for (int i = 0; i < numPrimitives; ++i) {
+            glm::vec3 position = (glm::vec3(random(), random(), random()) * 2.0f - 1.0f) * extent;
+            float scale = 0.25f + 0.75f * random();
+
+            Transform& transform = instanceTransforms_.emplace_back();
+            transform.SetPosition(position);
+            transform.SetRotation(random() * 360.0f, random() * 360.0f, random() * 360.0f);
+            transform.SetScale(scale, scale, scale);
+
+            Instance& instance = instances_.emplace_back();
+            instance.primitiveType = (i % 2 == 0) ? PrimitiveType::Sphere : PrimitiveType::AABB;
+            instance.primitiveIndex = std::uniform_int_distribution<int>(0, (i % 2 == 0 ? maxSpheres : maxAABBs) - 1)(generator);
+            instance.SetTransform(transform.GetTransform());
+
+            // Bounds of the rotated primitive.
+            minimum_ = glm::min(minimum_, position - glm::vec3(scale * glm::sqrt(3.0f)));
+            maximum_ = glm::max(maximum_, position + glm::vec3(scale * glm::sqrt(3.0f)));
+        }
+
+        Upload();
+    }
+
+    Scene::~Scene() {
+        glDeleteBuffers(1, &objectBuffer_);
+        glDeleteBuffers(1, &instanceBuffer_);
+    }
+
+    void Scene::Upload() {
+        glGenBuffers(1, &objectBuffer_);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + maxSpheres * sizeof(Sphere) + sizeof(glm::vec4) + maxAABBs * sizeof(AABB), nullptr, GL_STATIC_DRAW);
+
+        {
+            std::size_t offset = 0;
+
+            // Set sphere object data.
+            // All primitives are uploaded (not just the active ones), instances may reference primitives past the active range.
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(int), &numActiveSpheres_);
+            offset += sizeof(glm::vec4);
+
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, maxSpheres * sizeof(Sphere), spheres_.data());
+            offset += maxSpheres * sizeof(Sphere);
+
+            // Set AABB object data.
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(int), &numActiveAABBs_);
+            offset += sizeof(glm::vec4);
+
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, maxAABBs * sizeof(AABB), aabbs_.data());
+        }
+
+        glGenBuffers(1, &instanceBuffer_);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer_);
+
+        {
+            int numInstances = static_cast<int>(instances_.size());
+
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + instances_.size() * sizeof(Instance), nullptr, GL_STATIC_DRAW);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(int), &numInstances);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4), instances_.size() * sizeof(Instance), instances_.data());
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        memoryUsage_ = sizeof(glm::vec4) + maxSpheres * sizeof(Sphere) + sizeof(glm::vec4) + maxAABBs * sizeof(AABB) + sizeof(glm::vec4) + instances_.size() * sizeof(Instance);
+
+        Bind();
+    }
+
+    void Scene::Bind() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, objectBuffer_); // Binding 1.
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, instanceBuffer_); // Binding 3.
+    }
+
+    void Scene::UpdateSphere(int index) const {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer_);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + index * sizeof(Sphere), sizeof(Sphere), &spheres_[index]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    void Scene::UpdateAABB(int index) const {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer_);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + maxSpheres * sizeof(Sphere) + sizeof(glm::vec4) + index * sizeof(AABB), sizeof(AABB), &aabbs_[index]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    void Scene::UpdateInstance(int index) const {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer_);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) + index * sizeof(Instance), sizeof(Instance), &instances_[index]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    std::vector<Sphere>& Scene::GetSpheres() {
+        return spheres_;
+    }
+
+    std::vector<AABB>& Scene::GetAABBs() {
+        return aabbs_;
+    }
+
+    int Scene::GetNumActiveSpheres() const {
+        return numActiveSpheres_;
+    }
+
+    int Scene::GetNumActiveAABBs() const {
+        return numActiveAABBs_;
+    }
+
+    std::vector<Instance>& Scene::GetInstances() {
+        return instances_;
+    }
+
+    std::vector<Transform>& Scene::GetInstanceTransforms() {
+        return instanceTransforms_;
+    }
+
+    const glm::vec3& Scene::GetMinimum() const {
+        return minimum_;
+    }
+
+    const glm::vec3& Scene::GetMaximum() const {
+        return maximum_;
+    }
+
+    std::size_t Scene::GetMemoryUsage() const {
+        return memoryUsage_;
+    }
+
+}
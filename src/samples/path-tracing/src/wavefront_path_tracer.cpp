@@ -0,0 +1,201 @@
+
+#include "pch.h"
+#include "wavefront_path_tracer.h"
+
+namespace OpenGL {
+
+    namespace {
+
+        const int workGroupSize = 64; // Rays per work group of the extend stage and the sort.
+        const int numSortBins = 1 << 14; // See SortKey in path_tracing.comp.
+
+        const std::size_t raySize = 64; // See WavefrontRay in path_tracing.comp.
+        const std::size_t rayQueueHeaderSize = 4 * sizeof(GLuint); // Number of rays, indirect dispatch arguments.
+
+        // Ray queues are read and written by consecutive dispatches, and hold the arguments of indirect dispatches.
+        const GLbitfield wavefrontBarrier = GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT;
+
+    }
+
+    WavefrontPathTracer::WavefrontPathTracer(const std::vector<Shader::ShaderDefine>& defines) : rayQueues_ { 0, 0 },
+                                                                                                 sortKeyBuffer_(0),
+                                                                                                 sortBinBuffer_(0),
+                                                                                                 pixelRadianceBuffer_(0),
+                                                                                                 capacity_(0) {
+        // Every stage of wavefront path tracing is a separate shader, compiled from the same source.
+        auto createStage = [&defines](const std::string& stage) {
+            std::vector<Shader::ShaderDefine> stageDefines = defines;
+            stageDefines.emplace_back("WAVEFRONT_WORK_GROUP_SIZE", std::to_string(workGroupSize));
+            stageDefines.emplace_back(stage, "1");
+
+            return std::make_unique<Shader>("Wavefront Path Tracing (" + stage + ")", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/path_tracing.comp" }, stageDefines);
+        };
+
+        auto createSortStage = [](const std::string& stage) {
+            return std::make_unique<Shader>("Ray Sort (" + stage + ")", std::initializer_list<std::string> { "src/samples/path-tracing/assets/shaders/ray_sort.comp" },
+                                            std::vector<Shader::ShaderDefine> { { stage, "1" },
+                                                                                { "NUM_SORT_BINS", std::to_string(numSortBins) },
+                                                                                { "WAVEFRONT_WORK_GROUP_SIZE", std::to_string(workGroupSize) } });
+        };
+
+        generateShader_ = createStage("WAVEFRONT_GENERATE");
+        extendShader_ = createStage("WAVEFRONT_EXTEND");
+        resolveShader_ = createStage("WAVEFRONT_RESOLVE");
+
+        dispatchArgumentsShader_ = createSortStage("DISPATCH_ARGUMENTS");
+        histogramShader_ = createSortStage("HISTOGRAM");
+        scanShader_ = createSortStage("SCAN");
+        scatterShader_ = createSortStage("SCATTER");
+
+        glGenBuffers(2, rayQueues_);
+        glGenBuffers(1, &sortKeyBuffer_);
+        glGenBuffers(1, &pixelRadianceBuffer_);
+
+        // Number of rays per sort key.
+        glGenBuffers(1, &sortBinBuffer_);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortBinBuffer_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, numSortBins * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    WavefrontPathTracer::~WavefrontPathTracer() {
+        glDeleteBuffers(2, rayQueues_);
+        glDeleteBuffers(1, &sortKeyBuffer_);
+        glDeleteBuffers(1, &sortBinBuffer_);
+        glDeleteBuffers(1, &pixelRadianceBuffer_);
+    }
+
+    void WavefrontPathTracer::Reserve(std::size_t numRays) {
+        if (numRays <= capacity_) {
+            return;
+        }
+
+        for (GLuint rayQueue : rayQueues_) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayQueue);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(rayQueueHeaderSize + numRays * raySize), nullptr, GL_DYNAMIC_COPY);
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortKeyBuffer_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(numRays * sizeof(GLuint)), nullptr, GL_DYNAMIC_COPY);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixelRadianceBuffer_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(numRays * sizeof(glm::vec4)), nullptr, GL_DYNAMIC_COPY);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        capacity_ = numRays;
+    }
+
+    Shader& WavefrontPathTracer::GetGenerateShader() {
+        return *generateShader_;
+    }
+
+    Shader& WavefrontPathTracer::GetExtendShader() {
+        return *extendShader_;
+    }
+
+    Shader& WavefrontPathTracer::GetResolveShader() {
+        return *resolveShader_;
+    }
+
+    void WavefrontPathTracer::Dispatch(const glm::ivec2& offset, const glm::ivec2& size, int samplesPerPixel, int numRayBounces, bool sortRays, const glm::vec3& sceneMinimum, const glm::vec3& sceneMaximum) {
+        GLuint numRays = static_cast<GLuint>(size.x * size.y);
+        GLuint numRayWorkGroups = (numRays + static_cast<GLuint>(workGroupSize) - 1) / static_cast<GLuint>(workGroupSize);
+
+        // Generate and resolve stages run one invocation per pixel.
+        glm::ivec3 pixelWorkGroupSize = generateShader_->GetWorkGroupSize();
+        glm::ivec2 numWorkGroups((size.x + pixelWorkGroupSize.x - 1) / pixelWorkGroupSize.x, (size.y + pixelWorkGroupSize.y - 1) / pixelWorkGroupSize.y);
+
+        extendShader_->Bind();
+        extendShader_->SetUniform("sceneMinimum", sceneMinimum);
+        extendShader_->SetUniform("sceneMaximum", sceneMaximum);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, sortKeyBuffer_);
+
+        for (int sample = 0; sample < samplesPerPixel; ++sample) {
+            // Every pixel of the region starts a path with a camera ray.
+            GLuint header[4] = { numRays, numRayWorkGroups, 1, 1 };
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayQueues_[0]);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rayQueues_[0]);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, pixelRadianceBuffer_);
+
+            generateShader_->Bind();
+            generateShader_->SetUniform("regionOffset", offset);
+            generateShader_->SetUniform("regionSize", size);
+            generateShader_->SetUniform("sampleIndex", sample);
+            glDispatchCompute(numWorkGroups.x, numWorkGroups.y, 1);
+            glMemoryBarrier(wavefrontBarrier);
+
+            int input = 0;
+
+            for (int bounce = 0; bounce < numRayBounces; ++bounce) {
+                int output = 1 - input;
+
+                // Trace and shade every ray in the input queue, continuing paths are appended to the output queue.
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayQueues_[output]);
+                glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rayQueues_[input]);
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, rayQueues_[output]);
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, pixelRadianceBuffer_);
+
+                extendShader_->Bind();
+                extendShader_->SetUniform("bounceIndex", bounce);
+                glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, rayQueues_[input]);
+                glDispatchComputeIndirect(sizeof(GLuint)); // Number of work groups follows the number of rays.
+                glMemoryBarrier(wavefrontBarrier);
+
+                if (bounce == numRayBounces - 1) {
+                    // Rays queued by the last bounce are never traced.
+                    break;
+                }
+
+                dispatchArgumentsShader_->Bind();
+                glDispatchCompute(1, 1, 1);
+                glMemoryBarrier(wavefrontBarrier);
+
+                if (sortRays) {
+                    // Counting sort from the output queue back into the input queue.
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortBinBuffer_);
+                    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+                    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, sortBinBuffer_);
+
+                    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, rayQueues_[output]);
+
+                    histogramShader_->Bind();
+                    glDispatchComputeIndirect(sizeof(GLuint));
+                    glMemoryBarrier(wavefrontBarrier);
+
+                    scanShader_->Bind();
+                    glDispatchCompute(1, 1, 1);
+                    glMemoryBarrier(wavefrontBarrier);
+
+                    scatterShader_->Bind();
+                    glDispatchComputeIndirect(sizeof(GLuint));
+                    glMemoryBarrier(wavefrontBarrier);
+                }
+                else {
+                    // Rays are traced in the order they were queued.
+                    input = output;
+                }
+            }
+        }
+
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // Accumulate the radiance of all samples.
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, pixelRadianceBuffer_);
+
+        resolveShader_->Bind();
+        resolveShader_->SetUniform("regionOffset", offset);
+        resolveShader_->SetUniform("regionSize", size);
+        glDispatchCompute(numWorkGroups.x, numWorkGroups.y, 1);
+    }
+
+    std::size_t WavefrontPathTracer::GetMemoryUsage() const {
+        return 2 * (rayQueueHeaderSize + capacity_ * raySize) + capacity_ * (sizeof(GLuint) + sizeof(glm::vec4)) + numSortBins * sizeof(GLuint);
+    }
+
+}